@@ -1,18 +1,88 @@
 #include "ast.h"
+#include "listas.h"
+#include "intrinsecas.h"
+#include "memoria.h"
+#include "perfil.h"
+#include "pgo.h"
+#include "segun.h"
+#include "presupuesto.h"
 #include <iostream>
 #include <cstring>
 #include <map>
 #include <string>
 #include <vector>
 #include <variant>
+#include <charconv>
+#include <set>
 
-struct VarInfo {
-    std::string tipo; // "int", "float", "string"
-    Value valor;
-};
+// Estado del interprete, uno por hilo (en --lote cada hilo ejecuta sus registros)
+static thread_local std::map<std::string, VarInfo> variables;
+static thread_local std::map<std::string, std::pair<AST*, std::vector<std::string>>> funciones;
+
+thread_local std::ostream* salida_programa = &std::cout;
+thread_local void (*fuente_entrada)(const std::string& var, std::string& linea) = nullptr;
+
+void reiniciar_interprete() {
+    variables.clear();
+    funciones.clear();
+}
+
+std::map<std::string, VarInfo>& variables_interprete() {
+    return variables;
+}
+
+std::map<std::string, std::pair<AST*, std::vector<std::string>>>& funciones_interprete() {
+    return funciones;
+}
+
+// Estimacion de los bytes que ocupa una tabla de variables (para --mem-stats)
+static size_t bytes_string(const std::string& s) {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+// cabecera de un nodo de std::map mas la entrada
+static const size_t BYTES_NODO_VARIABLE = 32 + sizeof(std::pair<const std::string, VarInfo>);
+
+static size_t bytes_variables(const std::map<std::string, VarInfo>& tabla) {
+    size_t bytes = 0;
+    for (const auto& [nombre, info] : tabla) {
+        bytes += BYTES_NODO_VARIABLE;
+        bytes += bytes_string(nombre) + bytes_string(info.tipo);
+        if (info.valor.type == Value::STRING)
+            bytes += bytes_string(std::get<std::string>(info.valor.val));
+        else if (info.valor.type == Value::LIST)
+            bytes += sizeof(Lista) + info.valor.asList()->enteros.capacity() * sizeof(int) +
+                     info.valor.asList()->flotantes.capacity() * sizeof(float);
+    }
+    return bytes;
+}
+
+size_t bytes_variables_interprete() {
+    return bytes_variables(variables);
+}
 
-static std::map<std::string, VarInfo> variables;
-static std::map<std::string, std::pair<AST*, std::vector<std::string>>> funciones;
+// Marco de una llamada del interprete. Al salir, tambien si un limite o un error
+// aislado corta la ejecucion, cierra el perfil y la memoria de la llamada y
+// restaura las variables de quien llamo.
+struct MarcoLlamada {
+    std::map<std::string, VarInfo> guardadas;
+    size_t bytes_copia;
+    size_t bytes_marco = 0;
+    bool midiendo = false;
+    bool perfilando = false;
+
+    MarcoLlamada() : guardadas(variables), bytes_copia(guardadas.size() * BYTES_NODO_VARIABLE) {
+        bytes_marcos += bytes_copia;
+        profundidad_llamadas++;
+    }
+    ~MarcoLlamada() {
+        if (perfilando) perfil_salir();
+        if (midiendo) memoria_salir_llamada(bytes_marco);
+        bytes_marcos -= bytes_copia;
+        profundidad_llamadas--;
+        variables = std::move(guardadas);
+    }
+};
 
 const char* op_to_str(int op) {
     switch (op) {
@@ -139,6 +209,7 @@ AST* make_func_call(const char* name, AST* args) {
     node->type = NODE_FUNC_CALL;
     node->data.func_call.name = strdup(name);
     node->data.func_call.args = args;
+    node->data.func_call.intrinseca = nullptr;
     return node;
 }
 
@@ -178,9 +249,447 @@ AST* make_input(AST* variable) {
     return node;
 }
 
+AST* make_foto() {
+    AST* node = new AST;
+    node->type = NODE_FOTO;
+    return node;
+}
+
+AST* make_concat(std::vector<AST*>* partes) {
+    AST* node = new AST;
+    node->type = NODE_CONCAT;
+    node->data.concat.partes = partes;
+    return node;
+}
+
+AST* make_list(std::vector<AST*>* elementos) {
+    AST* node = new AST;
+    node->type = NODE_LIST;
+    node->data.lista.elementos = elementos;
+    return node;
+}
+
+AST* make_index(AST* lista, AST* indice) {
+    AST* node = new AST;
+    node->type = NODE_INDEX;
+    node->data.index.lista = lista;
+    node->data.index.indice = indice;
+    node->data.index.valor = nullptr;
+    return node;
+}
+
+AST* make_index_assign(AST* lista, AST* indice, AST* valor) {
+    AST* node = new AST;
+    node->type = NODE_INDEX_ASSIGN;
+    node->data.index.lista = lista;
+    node->data.index.indice = indice;
+    node->data.index.valor = valor;
+    return node;
+}
+
+AST* make_segun(AST* expr, std::vector<AST*>* casos, AST* defecto) {
+    AST* node = new AST;
+    node->type = NODE_SWITCH;
+    node->data.segun.expr = expr;
+    node->data.segun.claves = new std::vector<AST*>();
+    node->data.segun.cuerpos = new std::vector<AST*>();
+    for (size_t i = 0; i + 1 < casos->size(); i += 2) {
+        node->data.segun.claves->push_back((*casos)[i]);
+        node->data.segun.cuerpos->push_back((*casos)[i + 1]);
+    }
+    delete casos;
+    node->data.segun.defecto = defecto;
+    node->data.segun.tabla = armar_tabla_segun(*node->data.segun.claves);
+    node->data.segun.valor_del_ultimo = false;
+    return node;
+}
+
+std::vector<AST**> ast_hijos(AST* tree) {
+    std::vector<AST**> hijos;
+    if (!tree) return hijos;
+
+    switch (tree->type) {
+        case NODE_ASSIGN:
+        case NODE_BINOP:
+            hijos = {&tree->data.bin.left, &tree->data.bin.right};
+            break;
+        case NODE_PRINT:
+            hijos = {&tree->data.bin.left};
+            break;
+        case NODE_IF:
+        case NODE_WHILE:
+            hijos = {&tree->data.ctrl.cond, &tree->data.ctrl.then_branch, &tree->data.ctrl.else_branch};
+            break;
+        case NODE_FOR:
+            hijos = {&tree->data.for_loop.init, &tree->data.for_loop.cond,
+                     &tree->data.for_loop.update, &tree->data.for_loop.body};
+            break;
+        case NODE_SEQ:
+            hijos = {&tree->data.seq.first, &tree->data.seq.second};
+            break;
+        case NODE_FUNC_DEF:
+            hijos = {&tree->data.func_def.params, &tree->data.func_def.body};
+            break;
+        case NODE_FUNC_CALL:
+            hijos = {&tree->data.func_call.args};
+            break;
+        case NODE_ARGS:
+            if (tree->data.args.values)
+                for (AST*& arg : *(tree->data.args.values)) hijos.push_back(&arg);
+            break;
+        case NODE_CONCAT:
+            for (AST*& parte : *(tree->data.concat.partes)) hijos.push_back(&parte);
+            break;
+        case NODE_LIST:
+            for (AST*& elem : *(tree->data.lista.elementos)) hijos.push_back(&elem);
+            break;
+        case NODE_RETURN:
+            hijos = {&tree->data.ret.expr};
+            break;
+        case NODE_INPUT:
+            hijos = {&tree->data.input.variable};
+            break;
+        case NODE_INDEX:
+        case NODE_INDEX_ASSIGN:
+            hijos = {&tree->data.index.lista, &tree->data.index.indice, &tree->data.index.valor};
+            break;
+        case NODE_SWITCH:
+            hijos = {&tree->data.segun.expr};
+            for (size_t i = 0; i < tree->data.segun.claves->size(); ++i) {
+                hijos.push_back(&(*tree->data.segun.claves)[i]);
+                hijos.push_back(&(*tree->data.segun.cuerpos)[i]);
+            }
+            hijos.push_back(&tree->data.segun.defecto);
+            break;
+        default:
+            break;
+    }
+    return hijos;
+}
+
+// Texto de una parte de una concatenacion. Los numeros se formatean en 'buf'
+// con el mismo formato que std::to_string, los strings apuntan al valor original.
+struct PiezaTexto {
+    const char* ptr = "";
+    size_t len = 0;
+    char buf[64];
+    std::string texto; // solo para listas
+};
+
+static void formatear_pieza(const Value& v, PiezaTexto& pieza) {
+    switch (v.type) {
+        case Value::STRING: {
+            const std::string& s = std::get<std::string>(v.val);
+            pieza.ptr = s.data();
+            pieza.len = s.size();
+            break;
+        }
+        case Value::INT: {
+            auto res = std::to_chars(pieza.buf, pieza.buf + sizeof(pieza.buf), v.asInt());
+            pieza.ptr = pieza.buf;
+            pieza.len = res.ptr - pieza.buf;
+            break;
+        }
+        case Value::FLOAT: {
+            auto res = std::to_chars(pieza.buf, pieza.buf + sizeof(pieza.buf), (double)v.asFloat(),
+                                     std::chars_format::fixed, 6);
+            pieza.ptr = pieza.buf;
+            pieza.len = res.ptr - pieza.buf;
+            break;
+        }
+        case Value::LIST: {
+            pieza.texto = lista_a_texto(*v.asList());
+            pieza.ptr = pieza.texto.data();
+            pieza.len = pieza.texto.size();
+            break;
+        }
+        default:
+            pieza.ptr = "";
+            pieza.len = 0;
+    }
+}
+
+// Evalua todas las partes antes de formatear, asi el orden de efectos es el mismo
+// que tenia la cadena de sumas original
+static void evaluar_partes(AST* concat, std::vector<Value>& valores) {
+    const std::vector<AST*>& partes = *concat->data.concat.partes;
+    valores.resize(partes.size());
+    for (size_t i = 0; i < partes.size(); ++i)
+        valores[i] = eval_ast(partes[i]);
+}
+
+static Value llamar_intrinseca(const Intrinseca* in, AST* args_node) {
+    Value args[MAX_ARGS_INTRINSECA];
+    size_t n = (args_node && args_node->data.args.values) ? args_node->data.args.values->size() : 0;
+    if (n < in->min_args || n > in->max_args) {
+        error_ejecucion(std::string("cantidad de argumentos invalida para '") + in->nombre + "'");
+    }
+    for (size_t i = 0; i < n; ++i)
+        args[i] = eval_ast(args_node->data.args.values->at(i));
+    return in->funcion(args, n);
+}
+
+static size_t indice_lista(const Value& indice, size_t largo) {
+    if (indice.type != Value::INT || indice.asInt() < 0 || (size_t)indice.asInt() >= largo) {
+        error_ejecucion("indice fuera de rango");
+    }
+    return indice.asInt();
+}
+
+bool es_verdadero(const Value& v) {
+    return (v.type == Value::INT && v.asInt() != 0) ||
+           (v.type == Value::FLOAT && v.asFloat() != 0.0f);
+}
+
+Value operar_binop(int op, const Value& lhs, const Value& rhs) {
+    if (lhs.type == Value::LIST || rhs.type == Value::LIST) {
+        if (op == OP_EQ || op == OP_NEQ) {
+            bool iguales = lhs.type == Value::LIST && rhs.type == Value::LIST &&
+                           listas_iguales(*lhs.asList(), *rhs.asList());
+            return Value((iguales == (op == OP_EQ)) ? 1 : 0);
+        }
+        return operar_con_listas(op, lhs, rhs);
+    }
+
+    switch (op) {
+        case OP_PLUS: {
+            if (lhs.type == Value::STRING || rhs.type == Value::STRING) {
+                std::string s1 = (lhs.type == Value::STRING) ? lhs.asString() :
+                                (lhs.type == Value::INT) ? std::to_string(lhs.asInt()) :
+                                (lhs.type == Value::FLOAT) ? std::to_string(lhs.asFloat()) :
+                                "";
+
+                std::string s2;
+                if (rhs.type == Value::STRING) {
+                    s2 = rhs.asString();
+                } else if (rhs.type == Value::INT) {
+                    s2 = std::to_string(rhs.asInt());
+                } else if (rhs.type == Value::FLOAT) {
+                    s2 = std::to_string(rhs.asFloat());
+                } else {
+                    std::cerr << "Error: No se puede convertir RHS a string\n";
+                    return Value();
+                }
+
+                reservar_memoria(s1.size() + s2.size() + 1);
+                return Value(s1 + s2);
+            } else if ((lhs.type == Value::INT || lhs.type == Value::FLOAT) &&
+                    (rhs.type == Value::INT || rhs.type == Value::FLOAT)) {
+                float res = (lhs.type == Value::FLOAT ? lhs.asFloat() : lhs.asInt()) +
+                            (rhs.type == Value::FLOAT ? rhs.asFloat() : rhs.asInt());
+                if (lhs.type == Value::INT && rhs.type == Value::INT && (int)res == res)
+                    return Value((int)res);
+                else
+                    return Value(res);
+            } else {
+                std::cerr << "Error: Operacion suma no soportada para estos tipos\n";
+                return Value();
+            }
+        }
+        case OP_MINUS:
+        case OP_MULT:
+        case OP_DIV: {
+            if (!((lhs.type == Value::INT || lhs.type == Value::FLOAT) &&
+                  (rhs.type == Value::INT || rhs.type == Value::FLOAT))) {
+                std::cerr << "Error: Operacion aritmetica no soportada para estos tipos\n";
+                return Value();
+            }
+
+            float l = (lhs.type == Value::FLOAT) ? lhs.asFloat() : lhs.asInt();
+            float r = (rhs.type == Value::FLOAT) ? rhs.asFloat() : rhs.asInt();
+            float res = 0;
+            switch (op) {
+                case OP_MINUS: res = l - r; break;
+                case OP_MULT:  res = l * r; break;
+                case OP_DIV:   res = (r != 0) ? (l / r) : 0; break;
+            }
+            if (lhs.type == Value::INT && rhs.type == Value::INT && (int)res == res)
+                return Value((int)res);
+            else
+                return Value(res);
+        }
+        case OP_EQ:
+        case OP_NEQ: {
+            bool result = (op == OP_EQ) ? (lhs.val == rhs.val) : (lhs.val != rhs.val);
+            return Value(result ? 1 : 0);
+        }
+        case OP_LT:
+        case OP_LEQ:
+        case OP_GT:
+        case OP_GEQ: {
+            if ((lhs.type == Value::INT || lhs.type == Value::FLOAT) &&
+                (rhs.type == Value::INT || rhs.type == Value::FLOAT)) {
+                
+                float l = (lhs.type == Value::FLOAT) ? lhs.asFloat() : lhs.asInt();
+                float r = (rhs.type == Value::FLOAT) ? rhs.asFloat() : rhs.asInt();
+                bool result = false;
+
+                switch (op) {
+                    case OP_LT:  result = l < r; break;
+                    case OP_LEQ: result = l <= r; break;
+                    case OP_GT:  result = l > r; break;
+                    case OP_GEQ: result = l >= r; break;
+                    default: break;
+                }
+
+                return Value(result ? 1 : 0);
+            } else {
+                std::cerr << "Error: Comparacion no soportada para estos tipos\n";
+                return Value();
+            }
+        }
+        default:
+            return Value();
+    }
+}
+
+Value valor_para_asignar(const std::string& tipo, const Value& val, const std::string& var) {
+    if ((tipo == "int" && val.type != Value::INT) ||
+        (tipo == "float" && val.type != Value::FLOAT && val.type != Value::INT) || 
+        (tipo == "string" && val.type != Value::STRING) ||
+        (tipo == "lista_int" && (val.type != Value::LIST || val.asList()->es_float)) ||
+        (tipo == "lista_float" && val.type != Value::LIST)) {
+        error_ejecucion("tipo incompatible en asignacion a variable '" + var + "'");
+    }
+    reservar_memoria(bytes_valor(val));
+
+    if (tipo == "float" && val.type == Value::INT)
+        return Value(static_cast<float>(val.asInt()));
+    if (tipo == "lista_float" && !val.asList()->es_float) {
+        auto lista = std::make_shared<Lista>();
+        lista->es_float = true;
+        lista->flotantes.assign(val.asList()->enteros.begin(), val.asList()->enteros.end());
+        return Value(lista);
+    }
+    return val;
+}
+
+Value leer_entrada(const std::string& tipo, const std::string& var) {
+    std::string input;
+    if (fuente_entrada)
+        fuente_entrada(var, input);
+    else
+        std::getline(std::cin, input);
+
+    try {
+        if (tipo == "int") {
+            size_t pos;
+            int i = std::stoi(input, &pos);
+            if (pos != input.size()) throw std::invalid_argument("No es int valido");
+            return Value(i);
+        }
+        else if (tipo == "float") {
+            size_t pos;
+            float f = std::stof(input, &pos);
+            if (pos != input.size()) throw std::invalid_argument("No es float valido");
+            return Value(f);
+        }
+        else if (tipo == "string") {
+            return Value(input);
+        }
+        else {
+            error_ejecucion("tipo desconocido para variable " + var);
+        }
+    } catch (std::exception& e) {
+        error_ejecucion("entrada invalida para tipo " + tipo);
+    }
+}
+
+void imprimir_valor(const Value& val) {
+    std::ostream& out = *salida_programa;
+    switch (val.type) {
+        case Value::INT: out << val.asInt(); break;
+        case Value::FLOAT: out << val.asFloat(); break;
+        case Value::STRING: out << val.asString(); break;
+        case Value::LIST: out << lista_a_texto(*val.asList()); break;
+        default: out << "null";
+    }
+    out << std::endl;
+}
+
+static void formatear_partes(const Value* valores, size_t n, std::vector<PiezaTexto>& piezas) {
+    piezas.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        formatear_pieza(valores[i], piezas[i]);
+}
+
+// Una parte sin valor no se puede formatear: se suma como en la cadena de sumas
+// original (que asocia a la derecha), con el mismo error de OP_PLUS
+static bool tiene_parte_nula(const Value* valores, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (valores[i].type == Value::NONE) return true;
+    return false;
+}
+
+static Value sumar_partes(const Value* valores, size_t n) {
+    Value res = valores[n - 1];
+    for (size_t i = n - 1; i-- > 0;)
+        res = operar_binop(OP_PLUS, valores[i], res);
+    return res;
+}
+
+void imprimir_partes(const Value* valores, size_t n) {
+    if (tiene_parte_nula(valores, n)) {
+        imprimir_valor(sumar_partes(valores, n));
+        return;
+    }
+    // se escribe cada parte directo a la salida, sin armar el string completo
+    std::vector<PiezaTexto> piezas;
+    formatear_partes(valores, n, piezas);
+    for (const PiezaTexto& pieza : piezas)
+        salida_programa->write(pieza.ptr, pieza.len);
+    *salida_programa << std::endl;
+}
+
+Value concatenar_partes(const Value* valores, size_t n) {
+    if (tiene_parte_nula(valores, n)) return sumar_partes(valores, n);
+    std::vector<PiezaTexto> piezas;
+    formatear_partes(valores, n, piezas);
 
+    size_t total = 0;
+    for (const PiezaTexto& pieza : piezas) total += pieza.len;
+    reservar_memoria(total + 1);
 
+    std::string res;
+    res.reserve(total);
+    for (const PiezaTexto& pieza : piezas) res.append(pieza.ptr, pieza.len);
+    return Value(std::move(res));
+}
+
+Value crear_lista(const Value* valores, size_t n) {
+    reservar_memoria(sizeof(Lista) + n * sizeof(float));
+    auto lista = std::make_shared<Lista>();
+    for (size_t i = 0; i < n; ++i) {
+        if (valores[i].type != Value::INT && valores[i].type != Value::FLOAT) {
+            error_ejecucion("las listas solo pueden tener numeros");
+        }
+        lista->es_float = lista->es_float || valores[i].type == Value::FLOAT;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const Value& v = valores[i];
+        if (lista->es_float)
+            lista->flotantes.push_back(v.type == Value::FLOAT ? v.asFloat() : v.asInt());
+        else
+            lista->enteros.push_back(v.asInt());
+    }
+    return Value(lista);
+}
+
+Value indexar_lista(const Value& lista, const Value& indice) {
+    if (lista.type != Value::LIST) {
+        error_ejecucion("solo se puede indexar una lista");
+    }
+    size_t i = indice_lista(indice, lista.asList()->largo());
+    if (lista.asList()->es_float) return Value(lista.asList()->flotantes[i]);
+    return Value(lista.asList()->enteros[i]);
+}
 
+// Condicion de un si_po o de un ciclo; con --pgo-grabar se cuenta en el sitio
+static bool evaluar_condicion(AST* tree, AST* cond) {
+    bool cumple = es_verdadero(eval_ast(cond));
+    if (pgo_grabando) pgo_rama(tree->sitio, cumple);
+    return cumple;
+}
 
 Value eval_ast(AST* tree) {
     if (!tree) return Value();
@@ -189,10 +698,10 @@ Value eval_ast(AST* tree) {
         case NODE_DECL: {
             std::string var = tree->data.decl.nombre;
             if (variables.count(var)) {
-                std::cerr << "Error: variable '" << var << "' ya declarada.\n";
-                exit(1);
+                error_ejecucion("variable '" + var + "' ya declarada.");
             }
             variables[var] = VarInfo{tree->data.decl.tipo, Value()};
+            if (memoria_activa) memoria_variables(bytes_variables(variables));
             return Value();
         }
 
@@ -208,8 +717,7 @@ Value eval_ast(AST* tree) {
         case NODE_ID: {
             std::string var = tree->data.id;
             if (variables.count(var) == 0) {
-                std::cerr << "Error: variable no definida: " << var << "\n";
-                exit(1);
+                error_ejecucion("variable no definida: " + var);
             }
             return variables[var].valor;
         }
@@ -217,164 +725,105 @@ Value eval_ast(AST* tree) {
         case NODE_ASSIGN: {
             std::string var = tree->data.bin.left->data.id;
             if (variables.count(var) == 0) {
-                std::cerr << "Error: asignacion a variable no declarada: " << var << "\n";
-                exit(1);
+                error_ejecucion("asignacion a variable no declarada: " + var);
             }
 
             Value val = eval_ast(tree->data.bin.right);
-            std::string tipo = variables[var].tipo;
-
-          
-            if ((tipo == "int" && val.type != Value::INT) ||
-                (tipo == "float" && val.type != Value::FLOAT && val.type != Value::INT) || 
-                (tipo == "string" && val.type != Value::STRING)) {
-                std::cerr << "Error: tipo incompatible en asignacion a variable '" << var << "'\n";
-                exit(1);
-            }
-
-           
-            if (tipo == "float" && val.type == Value::INT) {
-                variables[var].valor = Value(static_cast<float>(val.asInt()));
-            } else {
-                variables[var].valor = val;
-            }
-
-            return variables[var].valor;
+            VarInfo& info = variables[var];
+            info.valor = valor_para_asignar(info.tipo, val, var);
+            if (memoria_activa) memoria_variables(bytes_variables(variables));
+            return info.valor;
         }
 
         case NODE_PRINT: {
-            Value val = eval_ast(tree->data.bin.left);
-            switch (val.type) {
-                case Value::INT: std::cout << val.asInt(); break;
-                case Value::FLOAT: std::cout << val.asFloat(); break;
-                case Value::STRING: std::cout << val.asString(); break;
-                default: std::cout << "null";
-            }
-            std::cout << std::endl;
+            if (tree->data.bin.left && tree->data.bin.left->type == NODE_CONCAT) {
+                std::vector<Value> valores;
+                evaluar_partes(tree->data.bin.left, valores);
+                imprimir_partes(valores.data(), valores.size());
+                return Value();
+            }
+            imprimir_valor(eval_ast(tree->data.bin.left));
             return Value();
         }
         case NODE_BINOP: {
             Value lhs = eval_ast(tree->data.bin.left);
             Value rhs = eval_ast(tree->data.bin.right);
+            return operar_binop(tree->op, lhs, rhs);
+        }
+        case NODE_CONCAT: {
+            std::vector<Value> valores;
+            evaluar_partes(tree, valores);
+            return concatenar_partes(valores.data(), valores.size());
+        }
+        case NODE_LIST: {
+            std::vector<Value> valores;
+            for (AST* elem : *(tree->data.lista.elementos))
+                valores.push_back(eval_ast(elem));
+            return crear_lista(valores.data(), valores.size());
+        }
+        case NODE_INDEX: {
+            Value lista = eval_ast(tree->data.index.lista);
+            Value indice = eval_ast(tree->data.index.indice);
+            return indexar_lista(lista, indice);
+        }
+        case NODE_INDEX_ASSIGN: {
+            std::string var = tree->data.index.lista->data.id;
+            if (variables.count(var) == 0) {
+                error_ejecucion("asignacion a variable no declarada: " + var);
+            }
+            Value indice = eval_ast(tree->data.index.indice);
+            Value val = eval_ast(tree->data.index.valor);
 
-            switch (tree->op) {
-                case OP_PLUS: {
-                    if (lhs.type == Value::STRING || rhs.type == Value::STRING) {
-                        std::string s1 = (lhs.type == Value::STRING) ? lhs.asString() :
-                                        (lhs.type == Value::INT) ? std::to_string(lhs.asInt()) :
-                                        (lhs.type == Value::FLOAT) ? std::to_string(lhs.asFloat()) :
-                                        "";
-
-                        std::string s2;
-                        if (rhs.type == Value::STRING) {
-                            s2 = rhs.asString();
-                        } else if (rhs.type == Value::INT) {
-                            s2 = std::to_string(rhs.asInt());
-                        } else if (rhs.type == Value::FLOAT) {
-                            s2 = std::to_string(rhs.asFloat());
-                        } else {
-                            std::cerr << "Error: No se puede convertir RHS a string\n";
-                            return Value();
-                        }
-
-                        return Value(s1 + s2);
-                    } else if ((lhs.type == Value::INT || lhs.type == Value::FLOAT) &&
-                            (rhs.type == Value::INT || rhs.type == Value::FLOAT)) {
-                        float res = (lhs.type == Value::FLOAT ? lhs.asFloat() : lhs.asInt()) +
-                                    (rhs.type == Value::FLOAT ? rhs.asFloat() : rhs.asInt());
-                        if (lhs.type == Value::INT && rhs.type == Value::INT && (int)res == res)
-                            return Value((int)res);
-                        else
-                            return Value(res);
-                    } else {
-                        std::cerr << "Error: Operacion suma no soportada para estos tipos\n";
-                        return Value();
-                    }
-                }
-                case OP_MINUS:
-                case OP_MULT:
-                case OP_DIV: {
-                    if (!((lhs.type == Value::INT || lhs.type == Value::FLOAT) &&
-                          (rhs.type == Value::INT || rhs.type == Value::FLOAT))) {
-                        std::cerr << "Error: Operacion aritmetica no soportada para estos tipos\n";
-                        return Value();
-                    }
-
-                    float l = (lhs.type == Value::FLOAT) ? lhs.asFloat() : lhs.asInt();
-                    float r = (rhs.type == Value::FLOAT) ? rhs.asFloat() : rhs.asInt();
-                    float res = 0;
-                    switch (tree->op) {
-                        case OP_MINUS: res = l - r; break;
-                        case OP_MULT:  res = l * r; break;
-                        case OP_DIV:   res = (r != 0) ? (l / r) : 0; break;
-                    }
-                    if (lhs.type == Value::INT && rhs.type == Value::INT && (int)res == res)
-                        return Value((int)res);
-                    else
-                        return Value(res);
-                }
-                case OP_EQ:
-                case OP_NEQ: {
-                    bool result = (tree->op == OP_EQ) ? (lhs.val == rhs.val) : (lhs.val != rhs.val);
-                    return Value(result ? 1 : 0);
-                }
-                case OP_LT:
-                case OP_LEQ:
-                case OP_GT:
-                case OP_GEQ: {
-                    if ((lhs.type == Value::INT || lhs.type == Value::FLOAT) &&
-                        (rhs.type == Value::INT || rhs.type == Value::FLOAT)) {
-                        
-                        float l = (lhs.type == Value::FLOAT) ? lhs.asFloat() : lhs.asInt();
-                        float r = (rhs.type == Value::FLOAT) ? rhs.asFloat() : rhs.asInt();
-                        bool result = false;
-
-                        switch (tree->op) {
-                            case OP_LT:  result = l < r; break;
-                            case OP_LEQ: result = l <= r; break;
-                            case OP_GT:  result = l > r; break;
-                            case OP_GEQ: result = l >= r; break;
-                            default: break;
-                        }
-
-                        return Value(result ? 1 : 0);
-                    } else {
-                        std::cerr << "Error: Comparacion no soportada para estos tipos\n";
-                        return Value();
-                    }
-                }
-                default:
-                    return Value();
+            Value& actual = variables[var].valor;
+            if (actual.type != Value::LIST) {
+                error_ejecucion("'" + var + "' no es una lista");
             }
+            size_t i = indice_lista(indice, actual.asList()->largo());
+            if ((actual.asList()->es_float && val.type != Value::FLOAT && val.type != Value::INT) ||
+                (!actual.asList()->es_float && val.type != Value::INT)) {
+                error_ejecucion("tipo incompatible en asignacion a elemento de '" + var + "'");
+            }
+
+            // copia al escribir: si otra variable comparte la lista se separa antes de modificarla
+            if (actual.asList().use_count() > 1) {
+                reservar_memoria(bytes_valor(actual));
+                actual = Value(std::make_shared<Lista>(*actual.asList()));
+                if (memoria_activa) memoria_variables(bytes_variables(variables));
+            }
+
+            if (actual.asList()->es_float)
+                actual.asList()->flotantes[i] = (val.type == Value::FLOAT) ? val.asFloat() : val.asInt();
+            else
+                actual.asList()->enteros[i] = val.asInt();
+            return val;
         }
         case NODE_IF: {
-            Value cond = eval_ast(tree->data.ctrl.cond);
-            bool cond_true = (cond.type == Value::INT && cond.asInt() != 0) ||
-                             (cond.type == Value::FLOAT && cond.asFloat() != 0.0f);
-            if (cond_true)
+            if (evaluar_condicion(tree, tree->data.ctrl.cond))
                 return eval_ast(tree->data.ctrl.then_branch);
             else if (tree->data.ctrl.else_branch)
                 return eval_ast(tree->data.ctrl.else_branch);
             else
                 return Value();
         }
+        case NODE_SWITCH: {
+            const TablaSegun* tabla = tree->data.segun.tabla;
+            int caso = tabla->buscar(eval_ast(tree->data.segun.expr));
+            if (caso == tabla->casos) return eval_ast(tree->data.segun.defecto);
+            Value val = eval_ast((*tree->data.segun.cuerpos)[caso]);
+            if (tree->data.segun.valor_del_ultimo && caso != tabla->casos - 1) return Value();
+            return val;
+        }
         case NODE_WHILE: {
-            while (true) {
-                Value cond = eval_ast(tree->data.ctrl.cond);
-                bool cond_true = (cond.type == Value::INT && cond.asInt() != 0) ||
-                                 (cond.type == Value::FLOAT && cond.asFloat() != 0.0f);
-                if (!cond_true) break;
+            while (evaluar_condicion(tree, tree->data.ctrl.cond)) {
+                contar_paso();
                 eval_ast(tree->data.ctrl.then_branch);
             }
             return Value();
         }
         case NODE_FOR: {
             eval_ast(tree->data.for_loop.init);
-            while (true) {
-                Value cond = eval_ast(tree->data.for_loop.cond);
-                bool cond_true = (cond.type == Value::INT && cond.asInt() != 0) ||
-                                 (cond.type == Value::FLOAT && cond.asFloat() != 0.0f);
-                if (!cond_true) break;
+            while (evaluar_condicion(tree, tree->data.for_loop.cond)) {
+                contar_paso();
                 eval_ast(tree->data.for_loop.body);
                 eval_ast(tree->data.for_loop.update);
             }
@@ -383,46 +832,18 @@ Value eval_ast(AST* tree) {
         case NODE_INPUT: {
             AST* var_node = tree->data.input.variable;
             if (!var_node || var_node->type != NODE_ID) {
-                std::cerr << "Error: input espera una variable valida\n";
-                exit(1);
+                error_ejecucion("input espera una variable valida");
             }
 
             std::string var = var_node->data.id;
             if (variables.count(var) == 0) {
-                std::cerr << "Error: variable no declarada: " << var << "\n";
-                exit(1);
-            }
-
-            std::string tipo = variables[var].tipo;
-            std::string input;
-            std::getline(std::cin, input);
-
-            try {
-                if (tipo == "int") {
-                    size_t pos;
-                    int i = std::stoi(input, &pos);
-                    if (pos != input.size()) throw std::invalid_argument("No es int valido");
-                    variables[var].valor = Value(i);
-                }
-                else if (tipo == "float") {
-                    size_t pos;
-                    float f = std::stof(input, &pos);
-                    if (pos != input.size()) throw std::invalid_argument("No es float valido");
-                    variables[var].valor = Value(f);
-                }
-                else if (tipo == "string") {
-                    variables[var].valor = Value(input);
-                }
-                else {
-                    std::cerr << "Tipo desconocido para variable " << var << "\n";
-                    exit(1);
-                }
-            } catch (std::exception& e) {
-                std::cerr << "Error: entrada invalida para tipo " << tipo << "\n";
-                exit(1);
+                error_ejecucion("variable no declarada: " + var);
             }
 
-            return variables[var].valor;
+            VarInfo& info = variables[var];
+            info.valor = leer_entrada(info.tipo, var);
+            if (memoria_activa) memoria_variables(bytes_variables(variables));
+            return info.valor;
         }
 
 
@@ -438,9 +859,14 @@ Value eval_ast(AST* tree) {
             return Value();
         }
         case NODE_FUNC_CALL: {
+            if (tree->data.func_call.intrinseca)
+                return llamar_intrinseca(tree->data.func_call.intrinseca, tree->data.func_call.args);
+
             if (funciones.count(tree->data.func_call.name)) {
+                if (pgo_grabando) pgo_llamada(tree->sitio);
+                contar_paso();
                 auto [body, param_names] = funciones[tree->data.func_call.name];
-                auto saved_vars = variables;
+                MarcoLlamada marco;
 
                 std::vector<AST*> args;
                 if (tree->data.func_call.args && tree->data.func_call.args->data.args.values)
@@ -453,15 +879,28 @@ Value eval_ast(AST* tree) {
                     if (val.type == Value::INT) varinfo.tipo = "int";
                     else if (val.type == Value::FLOAT) varinfo.tipo = "float";
                     else if (val.type == Value::STRING) varinfo.tipo = "string";
+                    else if (val.type == Value::LIST) varinfo.tipo = val.asList()->es_float ? "lista_float" : "lista_int";
                     else varinfo.tipo = "unknown"; 
 
                     varinfo.valor = val;
                     variables[param_names[i]] = varinfo;
                 }
 
-                Value result = eval_ast(body);
-                variables = saved_vars; // restaura variables
-                return result;
+                if (memoria_activa) {
+                    marco.bytes_marco = bytes_variables(marco.guardadas);
+                    memoria_entrar_llamada(marco.bytes_marco);
+                    marco.midiendo = true;
+                    memoria_variables(bytes_variables(variables));
+                }
+
+                if (perfil_activo) {
+                    perfil_entrar(tree->data.func_call.name);
+                    marco.perfilando = true;
+                }
+                return eval_ast(body); // el marco restaura las variables
+
+            } else if (const Intrinseca* in = buscar_intrinseca(tree->data.func_call.name)) {
+                return llamar_intrinseca(in, tree->data.func_call.args);
             } else {
                 std::cerr << "Error: funcion '" << tree->data.func_call.name << "' no definida.\n";
                 return Value();
@@ -519,6 +958,20 @@ void print_ast(AST* tree, int indent) {
                 print_ast(tree->data.ctrl.else_branch, indent + 1);
             break;
 
+        case NODE_SWITCH:
+            std::cout << "SEGUN\n";
+            print_ast(tree->data.segun.expr, indent + 1);
+            for (size_t i = 0; i < tree->data.segun.claves->size(); ++i) {
+                print_indent(indent + 1); std::cout << "CASO\n";
+                print_ast((*tree->data.segun.claves)[i], indent + 2);
+                print_ast((*tree->data.segun.cuerpos)[i], indent + 2);
+            }
+            if (tree->data.segun.defecto) {
+                print_indent(indent + 1); std::cout << "SI_NO\n";
+                print_ast(tree->data.segun.defecto, indent + 2);
+            }
+            break;
+
         case NODE_WHILE:
             std::cout << "WHILE\n";
             print_ast(tree->data.ctrl.cond, indent + 1);
@@ -593,230 +1046,950 @@ void print_ast(AST* tree, int indent) {
             std::cout << "INPUT\n";
             print_ast(tree->data.input.variable, indent + 1);
             break;
+        case NODE_CONCAT:
+            std::cout << "CONCAT\n";
+            for (AST* parte : *(tree->data.concat.partes)) {
+                print_ast(parte, indent + 1);
+            }
+            break;
+        case NODE_LIST:
+            std::cout << "LISTA\n";
+            for (AST* elem : *(tree->data.lista.elementos)) {
+                print_ast(elem, indent + 1);
+            }
+            break;
+        case NODE_INDEX:
+            std::cout << "INDICE\n";
+            print_ast(tree->data.index.lista, indent + 1);
+            print_ast(tree->data.index.indice, indent + 1);
+            break;
+        case NODE_INDEX_ASSIGN:
+            std::cout << "ASSIGN_INDICE\n";
+            print_ast(tree->data.index.lista, indent + 1);
+            print_ast(tree->data.index.indice, indent + 1);
+            print_ast(tree->data.index.valor, indent + 1);
+            break;
+        case NODE_FOTO:
+            std::cout << "FOTO\n";
+            break;
         default:
             std::cout << "Nodo desconocido\n";
     }
 }
 
-std::string generar_programa(AST* tree) {
-    std::string codigo = "#include <iostream>\n#include <string>\nusing namespace std;\n\n";
+// Tipo que el generador conoce de una expresion. TG_INDEF: todavia no se sabe
+// (la inferencia parte de ahi). TG_MIXTO: cambia segun la llamada o la
+// ejecucion; en C++ queda como plantilla o 'auto'.
+enum TipoGen { TG_INDEF, TG_NADA, TG_ENTERO, TG_REAL, TG_TEXTO, TG_LISTA_ENTERO, TG_LISTA_REAL, TG_MIXTO };
+
+struct FuncionGen {
+    AST* def = nullptr;
+    std::vector<std::string> params;
+    std::set<std::string> locales; // variables declaradas en el cuerpo
+    std::set<std::string> usadas;  // variables leidas o escritas en el cuerpo
+    std::set<std::string> escritas;
+    std::set<std::string> llamadas;
+    TipoGen retorno = TG_INDEF;
+    bool sin_excepciones = false;
+};
 
-    // Genera funciones fuera del main
-    codigo += generate_code_funcs(tree);
+// Se marca cuando el programa generado usa concatenaciones y necesita _chl_texto
+static bool usa_concat = false;
+// Se marca cuando el programa generado usa listas y necesita sus operaciones
+static bool usa_listas = false;
+static bool usa_division = false;
+static bool usa_entrada = false;
+static bool usa_restaurar = false;
+// Tipo de cada variable declarada y de cada parametro (los nombres son unicos)
+static std::map<std::string, std::string> tipos_declarados;
+static std::map<std::string, TipoGen> tipos_params;
+static std::map<std::string, FuncionGen> funciones_gen;
+static std::set<const Intrinseca*> intrinsecas_usadas;
+// Cantidad de asignaciones y lecturas de cada variable, para saber cuales son const
+static std::map<std::string, int> escrituras;
+// Variables del programa principal que tambien usan las funciones: van fuera del main
+static std::set<std::string> variables_globales;
+// Declaraciones dentro de un bloque: se adelantan al inicio de la funcion (o del
+// main) porque el lenguaje las deja visibles despues del bloque
+static std::set<std::string> declaraciones_elevadas;
+
+static TipoGen tipo_de_decl(const std::string& tipo) {
+    if (tipo == "int") return TG_ENTERO;
+    if (tipo == "float") return TG_REAL;
+    if (tipo == "string") return TG_TEXTO;
+    if (tipo == "lista_int") return TG_LISTA_ENTERO;
+    if (tipo == "lista_float") return TG_LISTA_REAL;
+    return TG_MIXTO;
+}
 
-    // Abre el main
-    codigo += "int main() {\n";
+// Nombre del tipo en C++, vacio si no hay uno fijo
+static std::string nombre_tipo(TipoGen t) {
+    switch (t) {
+        case TG_NADA: return "void";
+        case TG_ENTERO: return "int32_t";
+        case TG_REAL: return "float";
+        case TG_TEXTO: return "string";
+        case TG_LISTA_ENTERO: return "vector<int32_t>";
+        case TG_LISTA_REAL: return "vector<float>";
+        default: return "";
+    }
+}
 
-    // Genera codigo que no sean funciones dentro del main
-    codigo += generate_code_main(tree);
+static std::string tipo_cpp(const std::string& tipo) {
+    return nombre_tipo(tipo_de_decl(tipo));
+}
 
-    // Cierra el main
-    codigo += "return 0;\n}\n";
+static bool es_numerico(TipoGen t) { return t == TG_ENTERO || t == TG_REAL; }
+static bool es_lista(TipoGen t) { return t == TG_LISTA_ENTERO || t == TG_LISTA_REAL; }
+static bool tipo_fijo(TipoGen t) { return t != TG_INDEF && t != TG_MIXTO; }
 
-    return codigo;
+static TipoGen juntar_tipos(TipoGen a, TipoGen b) {
+    if (a == TG_INDEF) return b;
+    if (b == TG_INDEF || a == b) return a;
+    return TG_MIXTO;
 }
 
-std::string generate_code_funcs(AST* tree) {
-    if (!tree) return "";
+static const std::vector<AST*>& argumentos(AST* llamada) {
+    static const std::vector<AST*> ninguno;
+    AST* args = llamada->data.func_call.args;
+    return args && args->data.args.values ? *args->data.args.values : ninguno;
+}
 
-    std::string codigo;
+static const Intrinseca* intrinseca_de(AST* llamada) {
+    const Intrinseca* in = llamada->data.func_call.intrinseca;
+    if (!in && !funciones_gen.count(llamada->data.func_call.name))
+        in = buscar_intrinseca(llamada->data.func_call.name);
+    return in;
+}
+
+static TipoGen tipo_expr(AST* tree);
+
+static TipoGen tipo_variable(const std::string& nombre) {
+    auto decl = tipos_declarados.find(nombre);
+    if (decl != tipos_declarados.end()) return tipo_de_decl(decl->second);
+    auto param = tipos_params.find(nombre);
+    if (param != tipos_params.end()) return param->second;
+    return TG_MIXTO;
+}
+
+static TipoGen tipo_binop(int op, TipoGen l, TipoGen r) {
+    if (op >= OP_EQ) return TG_ENTERO; // las comparaciones dan 1 o 0
+    if (l == TG_INDEF || r == TG_INDEF) return TG_INDEF;
+    if (l == TG_MIXTO || r == TG_MIXTO) return TG_MIXTO;
+    if (op == OP_PLUS && (l == TG_TEXTO || r == TG_TEXTO)) return TG_TEXTO;
+    if (es_lista(l) || es_lista(r)) {
+        bool real = op == OP_DIV || l == TG_LISTA_REAL || r == TG_LISTA_REAL || l == TG_REAL || r == TG_REAL;
+        return real ? TG_LISTA_REAL : TG_LISTA_ENTERO;
+    }
+    if (!es_numerico(l) || !es_numerico(r)) return TG_MIXTO;
+    // int / int da float si no es exacta: en C++ la division siempre es float
+    if (op == OP_DIV) return TG_REAL;
+    return (l == TG_ENTERO && r == TG_ENTERO) ? TG_ENTERO : TG_REAL;
+}
+
+static TipoGen tipo_intrinseca(const Intrinseca* in, const std::vector<TipoGen>& a) {
+    if (a.size() < in->min_args || a.size() > in->max_args) return TG_MIXTO;
+    for (TipoGen t : a)
+        if (!tipo_fijo(t)) return t;
+    std::string nombre = in->nombre;
+    if (nombre == "potencia") return (a[0] == TG_ENTERO && a[1] == TG_ENTERO) ? TG_ENTERO : TG_REAL;
+    if (nombre == "raiz") return TG_REAL;
+    if (nombre == "absoluto") return a[0];
+    if (nombre == "minimo" || nombre == "maximo") {
+        if (a.size() == 1) return a[0] == TG_LISTA_REAL ? TG_REAL : TG_ENTERO;
+        return (a[0] == TG_ENTERO && a[1] == TG_ENTERO) ? TG_ENTERO : TG_REAL;
+    }
+    if (nombre == "largo") return TG_ENTERO;
+    if (nombre == "subcadena" || nombre == "texto") return TG_TEXTO;
+    if (nombre == "sumatoria") return a[0] == TG_LISTA_REAL ? TG_REAL : TG_ENTERO;
+    if (nombre == "producto_punto")
+        return (a[0] == TG_LISTA_REAL || a[1] == TG_LISTA_REAL) ? TG_REAL : TG_ENTERO;
+    if (nombre == "rango") return TG_LISTA_ENTERO;
+    return TG_MIXTO;
+}
 
+static TipoGen tipo_expr(AST* tree) {
+    if (!tree) return TG_NADA;
+    switch (tree->type) {
+        case NODE_INT: return TG_ENTERO;
+        case NODE_FLOAT: return TG_REAL;
+        case NODE_STRING:
+        case NODE_CONCAT: return TG_TEXTO;
+        case NODE_ID: return tipo_variable(tree->data.id);
+        case NODE_ASSIGN: return tipo_variable(tree->data.bin.left->data.id);
+        case NODE_INPUT: return tipo_variable(tree->data.input.variable->data.id);
+        case NODE_BINOP:
+            return tipo_binop(tree->op, tipo_expr(tree->data.bin.left), tipo_expr(tree->data.bin.right));
+        case NODE_LIST: {
+            TipoGen t = TG_LISTA_ENTERO;
+            for (AST* elem : *(tree->data.lista.elementos)) {
+                TipoGen e = tipo_expr(elem);
+                if (e == TG_REAL) t = TG_LISTA_REAL;
+                else if (e != TG_ENTERO) return e == TG_INDEF ? TG_INDEF : TG_MIXTO;
+            }
+            return t;
+        }
+        case NODE_INDEX: {
+            TipoGen l = tipo_expr(tree->data.index.lista);
+            if (l == TG_LISTA_ENTERO) return TG_ENTERO;
+            if (l == TG_LISTA_REAL) return TG_REAL;
+            return l == TG_INDEF ? TG_INDEF : TG_MIXTO;
+        }
+        case NODE_FUNC_CALL: {
+            const Intrinseca* in = intrinseca_de(tree);
+            if (!in) {
+                auto f = funciones_gen.find(tree->data.func_call.name);
+                return f != funciones_gen.end() ? f->second.retorno : TG_MIXTO;
+            }
+            std::vector<TipoGen> tipos;
+            for (AST* arg : argumentos(tree)) tipos.push_back(tipo_expr(arg));
+            return tipo_intrinseca(in, tipos);
+        }
+        default:
+            return TG_NADA;
+    }
+}
+
+// Primer recorrido: tipos declarados, funciones, escrituras y variables que
+// usa cada funcion
+static void recolectar(AST* tree, FuncionGen* actual) {
+    if (!tree) return;
     switch (tree->type) {
+        case NODE_DECL:
+            tipos_declarados[tree->data.decl.nombre] = tree->data.decl.tipo;
+            if (actual) actual->locales.insert(tree->data.decl.nombre);
+            return;
         case NODE_FUNC_DEF: {
-            std::string nombre = tree->data.func_def.name;
-            std::string params_code = ""; 
-            if (tree->data.func_def.params) {
-                for (size_t i = 0; i < tree->data.func_def.params->data.params.names->size(); i++) {
-                    if (i > 0) params_code += ", ";
-                    params_code += "auto " + tree->data.func_def.params->data.params.names->at(i);
+            FuncionGen& f = funciones_gen[tree->data.func_def.name];
+            f.def = tree;
+            if (tree->data.func_def.params)
+                f.params = *(tree->data.func_def.params->data.params.names);
+            for (const std::string& p : f.params) tipos_params[p] = TG_INDEF;
+            recolectar(tree->data.func_def.body, &f);
+            return;
+        }
+        case NODE_ID:
+            if (actual) actual->usadas.insert(tree->data.id);
+            return;
+        case NODE_FUNC_CALL:
+            if (actual) actual->llamadas.insert(tree->data.func_call.name);
+            break;
+        case NODE_ASSIGN:
+            escrituras[tree->data.bin.left->data.id]++;
+            if (actual) actual->escritas.insert(tree->data.bin.left->data.id);
+            break;
+        case NODE_INPUT:
+            escrituras[tree->data.input.variable->data.id]++;
+            if (actual) actual->escritas.insert(tree->data.input.variable->data.id);
+            break;
+        case NODE_INDEX_ASSIGN:
+            escrituras[tree->data.index.lista->data.id]++;
+            if (actual) actual->escritas.insert(tree->data.index.lista->data.id);
+            break;
+        default:
+            break;
+    }
+    for (AST** hijo : ast_hijos(tree)) recolectar(*hijo, actual);
+}
+
+// Un resultado que a veces es int y a veces float queda como double, igual que
+// el resultado de int / int
+static void buscar_retornos(AST* tree, TipoGen& tipo, bool& hay) {
+    if (!tree || tree->type == NODE_FUNC_DEF) return;
+    if (tree->type == NODE_RETURN) {
+        TipoGen t = tipo_expr(tree->data.ret.expr);
+        tipo = es_numerico(tipo) && es_numerico(t) && tipo != t ? TG_REAL : juntar_tipos(tipo, t);
+        hay = true;
+    }
+    for (AST** hijo : ast_hijos(tree)) buscar_retornos(*hijo, tipo, hay);
+}
+
+static bool juntar_args(AST* tree) {
+    if (!tree) return false;
+    bool cambio = false;
+    if (tree->type == NODE_FUNC_CALL && !intrinseca_de(tree)) {
+        auto f = funciones_gen.find(tree->data.func_call.name);
+        if (f != funciones_gen.end()) {
+            const std::vector<AST*>& args = argumentos(tree);
+            for (size_t i = 0; i < args.size() && i < f->second.params.size(); ++i) {
+                TipoGen& p = tipos_params[f->second.params[i]];
+                TipoGen nuevo = juntar_tipos(p, tipo_expr(args[i]));
+                if (nuevo != p) {
+                    p = nuevo;
+                    cambio = true;
                 }
             }
-            std::string body_code = generate_code_main(tree->data.func_def.body);
-            codigo += "auto " + nombre + "(" + params_code + ") {\n" + body_code + "}\n\n";
-            break;
         }
-        case NODE_SEQ: {
-            codigo += generate_code_funcs(tree->data.seq.first);
-            codigo += generate_code_funcs(tree->data.seq.second);
+    }
+    for (AST** hijo : ast_hijos(tree)) cambio = juntar_args(*hijo) || cambio;
+    return cambio;
+}
+
+// Los parametros toman el tipo de los argumentos de todas las llamadas y el
+// resultado el de todos los devuelve_la_wa; se repite hasta que nada cambie
+static void inferir_tipos(AST* tree) {
+    for (int vuelta = 0; vuelta < 64; ++vuelta) {
+        bool cambio = juntar_args(tree);
+        for (auto& [nombre, f] : funciones_gen) {
+            TipoGen retorno = TG_INDEF;
+            bool hay = false;
+            buscar_retornos(f.def->data.func_def.body, retorno, hay);
+            if (!hay) retorno = TG_NADA;
+            if (retorno != f.retorno) {
+                f.retorno = retorno;
+                cambio = true;
+            }
+        }
+        if (!cambio) return;
+    }
+}
+
+static bool alcanza(const std::string& desde, const std::string& buscada, std::set<std::string>& vistas) {
+    auto f = funciones_gen.find(desde);
+    if (f == funciones_gen.end()) return false;
+    for (const std::string& llamada : f->second.llamadas) {
+        if (llamada == buscada) return true;
+        if (vistas.insert(llamada).second && alcanza(llamada, buscada, vistas)) return true;
+    }
+    return false;
+}
+
+// Resultados que 'auto' no puede deducir. Si nunca se devuelve un valor (solo
+// la llamada recursiva) cualquier tipo sirve; si una funcion recursiva devuelve
+// tipos distintos no hay un tipo de C++ que le sirva.
+static bool fijar_retornos_recursivos(std::string& motivo) {
+    for (auto& [nombre, f] : funciones_gen) {
+        if (f.retorno == TG_INDEF) {
+            f.retorno = TG_ENTERO;
+            continue;
+        }
+        if (tipo_fijo(f.retorno)) continue;
+        bool plantilla = false;
+        for (const std::string& p : f.params) plantilla = plantilla || !tipo_fijo(tipos_params[p]);
+        std::set<std::string> vistas;
+        if (!plantilla && alcanza(nombre, nombre, vistas)) {
+            motivo = "la funcion recursiva '" + nombre + "' devuelve valores de distintos tipos";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sin excepciones: solo numeros (sin strings, listas ni entrada) y solo
+// llamadas a funciones que tampoco lanzan
+static bool cuerpo_sin_excepciones(AST* tree) {
+    if (!tree) return true;
+    switch (tree->type) {
+        case NODE_INPUT:
+        case NODE_LIST:
+        case NODE_CONCAT:
+        case NODE_INDEX:
+        case NODE_INDEX_ASSIGN:
+        case NODE_STRING:
+            return false;
+        case NODE_FUNC_DEF:
+            return true;
+        case NODE_DECL:
+            return es_numerico(tipo_de_decl(tree->data.decl.tipo));
+        case NODE_PRINT:
+            // un literal va directo a cout, sin armar un string
+            if (tree->data.bin.left && tree->data.bin.left->type == NODE_STRING) return true;
+            break;
+        case NODE_BINOP:
+            if (!es_numerico(tipo_expr(tree))) return false;
+            break;
+        case NODE_FUNC_CALL: {
+            const Intrinseca* in = intrinseca_de(tree);
+            if (!in) {
+                auto f = funciones_gen.find(tree->data.func_call.name);
+                if (f == funciones_gen.end() || !f->second.sin_excepciones) return false;
+            } else {
+                if (in->usa_listas || !es_numerico(tipo_expr(tree))) return false;
+                for (AST* arg : argumentos(tree))
+                    if (!es_numerico(tipo_expr(arg))) return false;
+            }
             break;
         }
         default:
-            
             break;
     }
+    for (AST** hijo : ast_hijos(tree))
+        if (!cuerpo_sin_excepciones(*hijo)) return false;
+    return true;
+}
+
+static void marcar_sin_excepciones() {
+    for (auto& [nombre, f] : funciones_gen) f.sin_excepciones = true;
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        for (auto& [nombre, f] : funciones_gen) {
+            if (!f.sin_excepciones) continue;
+            bool sin = f.retorno == TG_NADA || es_numerico(f.retorno);
+            for (const std::string& p : f.params) sin = sin && es_numerico(tipos_params[p]);
+            sin = sin && cuerpo_sin_excepciones(f.def->data.func_def.body);
+            if (!sin) {
+                f.sin_excepciones = false;
+                cambio = true;
+            }
+        }
+    }
+}
+
+// Operaciones de listas para el C++ generado. Los ciclos quedan simples para que
+// el compilador los vectorice (-O3, y -fopenmp-simd para las reducciones).
+static std::string prelude_listas() {
+    std::string codigo;
+    codigo += "template<class T> ostream& operator<<(ostream& os, const vector<T>& v) {\n"
+              "os << \"[\";\nfor (size_t i = 0; i < v.size(); i++) { if (i > 0) os << \", \"; os << v[i]; }\n"
+              "return os << \"]\";\n}\n";
+    codigo += "template<class T, class U> using _chl_elem = conditional_t<is_floating_point_v<T> || is_floating_point_v<U>, float, int32_t>;\n";
+    codigo += "template<class T> int32_t _chl_largo(const vector<T>& v) { return (int32_t)v.size(); }\n";
+    codigo += "vector<int32_t> _chl_rango(int32_t n) { vector<int32_t> v(n); for (int32_t i = 0; i < n; i++) v[i] = i; return v; }\n";
+    codigo += "template<class T> T _chl_sumatoria(const vector<T>& v) {\nT s = 0;\n"
+              "#pragma omp simd reduction(+:s)\nfor (size_t i = 0; i < v.size(); i++) s += v[i];\nreturn s;\n}\n";
+    // una lista vacia termina con el mismo error del interprete
+    codigo += "template<class T> T _chl_minimo(const vector<T>& v) {\n"
+              "if (v.empty()) { cerr << \"Error: minimo de una lista vacia\\n\"; exit(1); }\nT m = v[0];\n"
+              "#pragma omp simd reduction(min:m)\nfor (size_t i = 1; i < v.size(); i++) m = v[i] < m ? v[i] : m;\nreturn m;\n}\n";
+    codigo += "template<class T> T _chl_maximo(const vector<T>& v) {\n"
+              "if (v.empty()) { cerr << \"Error: maximo de una lista vacia\\n\"; exit(1); }\nT m = v[0];\n"
+              "#pragma omp simd reduction(max:m)\nfor (size_t i = 1; i < v.size(); i++) m = v[i] > m ? v[i] : m;\nreturn m;\n}\n";
+    codigo += "template<class T, class U> _chl_elem<T, U> _chl_producto_punto(const vector<T>& a, const vector<U>& b) {\n"
+              "_chl_elem<T, U> s = 0;\n"
+              "#pragma omp simd reduction(+:s)\nfor (size_t i = 0; i < a.size(); i++) s += _chl_elem<T, U>(a[i]) * _chl_elem<T, U>(b[i]);\nreturn s;\n}\n";
+
+    // lista op escalar, escalar op lista y lista op lista; la division siempre da flotantes
+    const char* ops[] = {"+", "-", "*", "/"};
+    for (const char* op : ops) {
+        std::string o = op;
+        bool div = o == "/";
+        std::string res = div ? "float" : "_chl_elem<T, U>";
+        auto elem = [&](const std::string& a, const std::string& b) {
+            if (div) return "(" + b + " != 0 ? float(" + a + ") / float(" + b + ") : 0.0f)";
+            return "_chl_elem<T, U>(" + a + ") " + o + " _chl_elem<T, U>(" + b + ")";
+        };
+        std::string cuerpo_ini = "vector<" + res + "> r(";
+        codigo += "template<class T, class U, class = enable_if_t<is_arithmetic_v<U>>> vector<" + res + "> operator" + o +
+                  "(const vector<T>& a, U k) {\n" + cuerpo_ini + "a.size());\nfor (size_t i = 0; i < a.size(); i++) r[i] = " +
+                  elem("a[i]", "k") + ";\nreturn r;\n}\n";
+        codigo += "template<class T, class U, class = enable_if_t<is_arithmetic_v<U>>> vector<" + res + "> operator" + o +
+                  "(U k, const vector<T>& a) {\n" + cuerpo_ini + "a.size());\nfor (size_t i = 0; i < a.size(); i++) r[i] = " +
+                  elem("k", "a[i]") + ";\nreturn r;\n}\n";
+        codigo += "template<class T, class U> vector<" + res + "> operator" + o +
+                  "(const vector<T>& a, const vector<U>& b) {\n" + cuerpo_ini + "a.size());\nfor (size_t i = 0; i < a.size(); i++) r[i] = " +
+                  elem("a[i]", "b[i]") + ";\nreturn r;\n}\n";
+    }
+    return codigo + "\n";
+}
+
+// Lectura de una linea con el mismo chequeo que el interprete
+std::string prelude_entrada() {
+    return "static inline void _chl_entrada_invalida(const char* tipo) {\n"
+           "    cerr << \"Error: entrada invalida para tipo \" << tipo << \"\\n\";\n"
+           "    exit(1);\n}\n"
+           "static inline int32_t _chl_leer_int() {\n"
+           "    string s; getline(cin, s);\n"
+           "    size_t pos = 0; int32_t v = 0;\n"
+           "    try { v = stoi(s, &pos); } catch (...) { _chl_entrada_invalida(\"int\"); }\n"
+           "    if (pos != s.size()) _chl_entrada_invalida(\"int\");\n"
+           "    return v;\n}\n"
+           "static inline float _chl_leer_float() {\n"
+           "    string s; getline(cin, s);\n"
+           "    size_t pos = 0; float v = 0;\n"
+           "    try { v = stof(s, &pos); } catch (...) { _chl_entrada_invalida(\"float\"); }\n"
+           "    if (pos != s.size()) _chl_entrada_invalida(\"float\");\n"
+           "    return v;\n}\n"
+           "static inline string _chl_leer_string() {\n"
+           "    string s; getline(cin, s);\n"
+           "    return s;\n}\n\n";
+}
+
+// Salida sin sincronizar con stdio. Si el programa lee, cin sigue atado a cout
+// para que los mensajes salgan antes de esperar la entrada.
+std::string inicio_main(bool lee_entrada, const std::string& sangria) {
+    std::string codigo = sangria + "ios::sync_with_stdio(false);\n";
+    if (!lee_entrada) codigo += sangria + "cin.tie(nullptr);\n";
+    return codigo;
+}
+
+static std::string literal_texto_cpp(const std::string& s) {
+    std::string codigo = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') codigo += '\\';
+        if (c == '\n') { codigo += "\\n"; continue; }
+        codigo += c;
+    }
+    return codigo + "\"";
+}
+
+static std::string literal_real(float v) {
+    char buf[64];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    std::string s(buf, res.ptr);
+    if (s.find_first_of(".e") == std::string::npos) s += ".0";
+    return s + "f";
+}
+
+// Expresion convertida a string con el formato de to_string del interprete
+static std::string como_texto(AST* expr) {
+    if (expr->type == NODE_STRING) return "string(" + generate_code_main(expr) + ")";
+    if (tipo_expr(expr) == TG_TEXTO) return generate_code_main(expr);
+    usa_concat = true;
+    return "_chl_texto(" + generate_code_main(expr) + ")";
+}
+
+// [[likely]] / [[unlikely]] para las ramas de un si_po segun el perfil de --pgo-usar
+void marcas_probabilidad(int sitio, std::string& marca_si, std::string& marca_no) {
+    double p = pgo_probabilidad(sitio);
+    if (p < 0) return;
+    if (p >= PGO_RAMA_PROBABLE) {
+        marca_si = " [[likely]]";
+        marca_no = " [[unlikely]]";
+    } else if (p <= 1 - PGO_RAMA_PROBABLE) {
+        marca_si = " [[unlikely]]";
+        marca_no = " [[likely]]";
+    }
+}
+
+static bool es_expresion(AST* tree) {
+    switch (tree->type) {
+        case NODE_INT: case NODE_FLOAT: case NODE_STRING: case NODE_ID: case NODE_BINOP:
+        case NODE_CONCAT: case NODE_LIST: case NODE_INDEX: case NODE_FUNC_CALL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Una sentencia: las expresiones sueltas (llamadas, por ejemplo) se cierran con ';'
+static std::string generar_sentencia(AST* tree) {
+    if (!tree) return "";
+    std::string codigo = generate_code_main(tree);
+    return es_expresion(tree) ? codigo + ";\n" : codigo;
+}
+
+static void aplanar(AST* tree, std::vector<AST*>& sentencias) {
+    if (!tree) return;
+    if (tree->type == NODE_SEQ) {
+        aplanar(tree->data.seq.first, sentencias);
+        aplanar(tree->data.seq.second, sentencias);
+    } else {
+        sentencias.push_back(tree);
+    }
+}
+
+static void buscar_declaraciones(AST* tree, std::vector<AST*>& decls) {
+    if (!tree || tree->type == NODE_FUNC_DEF) return;
+    if (tree->type == NODE_DECL) decls.push_back(tree);
+    for (AST** hijo : ast_hijos(tree)) buscar_declaraciones(*hijo, decls);
+}
+
+// Cuerpo de una funcion o del main. Las declaraciones que no estan al nivel del
+// cuerpo se adelantan; 'tipo x; x = e;' queda como 'tipo x = e;', y const si
+// x no se vuelve a escribir.
+static std::string generar_cuerpo(AST* cuerpo) {
+    std::vector<AST*> sentencias;
+    aplanar(cuerpo, sentencias);
+
+    std::string codigo;
+    std::set<AST*> al_nivel(sentencias.begin(), sentencias.end());
+    std::vector<AST*> decls;
+    buscar_declaraciones(cuerpo, decls);
+    for (AST* decl : decls) {
+        std::string nombre = decl->data.decl.nombre;
+        if (al_nivel.count(decl) || variables_globales.count(nombre)) continue;
+        declaraciones_elevadas.insert(nombre);
+        codigo += tipo_cpp(decl->data.decl.tipo) + " " + nombre + "{};\n";
+    }
+
+    for (size_t i = 0; i < sentencias.size(); ++i) {
+        AST* s = sentencias[i];
+        AST* sig = i + 1 < sentencias.size() ? sentencias[i + 1] : nullptr;
+        if (s->type == NODE_DECL && sig && sig->type == NODE_ASSIGN &&
+            !variables_globales.count(s->data.decl.nombre) &&
+            s->data.decl.nombre == std::string(sig->data.bin.left->data.id)) {
+            std::string nombre = s->data.decl.nombre;
+            std::string asignacion = generate_code_main(sig);
+            codigo += (escrituras[nombre] == 1 ? "const " : "") + tipo_cpp(s->data.decl.tipo) + " " + asignacion;
+            ++i;
+            continue;
+        }
+        codigo += generar_sentencia(s);
+    }
+    return codigo;
+}
+
+bool generar_programa(AST* tree, std::string& codigo, std::string& motivo) {
+    usa_concat = false;
+    usa_listas = false;
+    usa_division = false;
+    usa_entrada = false;
+    usa_restaurar = false;
+    tipos_declarados.clear();
+    tipos_params.clear();
+    funciones_gen.clear();
+    intrinsecas_usadas.clear();
+    escrituras.clear();
+    variables_globales.clear();
+    declaraciones_elevadas.clear();
+
+    recolectar(tree, nullptr);
+    inferir_tipos(tree);
+    if (!fijar_retornos_recursivos(motivo)) return false;
+    marcar_sin_excepciones();
+
+    // lo que una funcion usa sin declararlo es del programa principal
+    std::set<std::string> de_funciones;
+    for (auto& [nombre, f] : funciones_gen) de_funciones.insert(f.locales.begin(), f.locales.end());
+    for (auto& [nombre, f] : funciones_gen) {
+        for (const std::string& var : f.usadas) {
+            if (f.locales.count(var) || de_funciones.count(var) || !tipos_declarados.count(var)) continue;
+            variables_globales.insert(var);
+        }
+    }
+
+    codigo = "#include <iostream>\n#include <string>\n#include <cstdint>\n";
+
+    // Genera funciones y main primero para saber que ayudas necesita el programa
+    std::string funcs = generate_code_funcs(tree);
+    std::string main_code = generar_cuerpo(tree);
+
+    if (usa_listas) codigo += "#include <vector>\n#include <type_traits>\n#include <sstream>\n";
+    if (!intrinsecas_usadas.empty()) codigo += "#include <cmath>\n#include <algorithm>\n#include <type_traits>\n";
+    if (usa_entrada || usa_listas) codigo += "#include <cstdlib>\n";
+    codigo += "using namespace std;\n\n";
+
+    if (usa_listas) codigo += prelude_listas();
+    if (usa_entrada) codigo += prelude_entrada();
+
+    for (const Intrinseca* in : intrinsecas_usadas) {
+        if (in->definicion_cpp) codigo += in->definicion_cpp;
+    }
+
+    if (usa_division)
+        codigo += "static inline float _chl_dividir(float a, float b) noexcept { return b != 0 ? a / b : 0.0f; }\n\n";
+
+    if (usa_concat) {
+        codigo += "string _chl_texto(const string& s) { return s; }\n";
+        codigo += "string _chl_texto(int v) { return to_string(v); }\n";
+        codigo += "string _chl_texto(float v) { return to_string(v); }\n";
+        if (usa_listas)
+            codigo += "template<class T> string _chl_texto(const vector<T>& v) { ostringstream os; os << v; return os.str(); }\n";
+        codigo += "\n";
+    }
+
+    if (usa_restaurar)
+        codigo += "template<class T> struct _chl_restaurar {\n"
+                  "T& variable;\nT valor;\n"
+                  "_chl_restaurar(T& v) : variable(v), valor(v) {}\n"
+                  "~_chl_restaurar() { variable = valor; }\n};\n\n";
+
+    for (const std::string& var : variables_globales)
+        codigo += tipo_cpp(tipos_declarados[var]) + " " + var + "{};\n";
+    if (!variables_globales.empty()) codigo += "\n";
+
+    // Funciones fuera del main
+    codigo += funcs;
+
+    // Abre el main
+    codigo += "int main() {\n";
+    codigo += inicio_main(usa_entrada);
+
+    // Codigo que no sean funciones dentro del main
+    codigo += main_code;
+
+    // Cierra el main
+    codigo += "return 0;\n}\n";
+
+    return true;
+}
+
+// Firma de una funcion: tipos inferidos; los parametros sin un tipo fijo quedan
+// como plantilla. Los que no se modifican son const (por referencia si son
+// strings o listas).
+static std::string firma_funcion(const FuncionGen& f, bool& es_plantilla) {
+    std::string plantilla, params;
+    for (size_t i = 0; i < f.params.size(); ++i) {
+        const std::string& p = f.params[i];
+        TipoGen t = tipos_params[p];
+        std::string tipo = nombre_tipo(t);
+        if (!tipo_fijo(t)) {
+            tipo = "T" + std::to_string(i);
+            plantilla += std::string(plantilla.empty() ? "" : ", ") + "class " + tipo;
+        }
+        if (i > 0) params += ", ";
+        if (escrituras[p] > 0) params += tipo + " " + p;
+        else if (es_numerico(t)) params += "const " + tipo + " " + p;
+        else params += "const " + tipo + "& " + p;
+    }
+    es_plantilla = !plantilla.empty();
+    std::string retorno = tipo_fijo(f.retorno) ? nombre_tipo(f.retorno) : "auto";
+    std::string codigo = es_plantilla ? "template<" + plantilla + ">\n" : "";
+    codigo += retorno + " " + std::string(f.def->data.func_def.name) + "(" + params + ")";
+    if (f.sin_excepciones) codigo += " noexcept";
+    return codigo;
+}
+
+std::string generate_code_funcs(AST* tree) {
+    if (!tree) return "";
+
+    // prototipos para poder llamar funciones definidas mas abajo
+    std::string prototipos;
+    std::vector<AST*> sentencias;
+    aplanar(tree, sentencias);
+    for (AST* s : sentencias) {
+        if (s->type != NODE_FUNC_DEF) continue;
+        const FuncionGen& f = funciones_gen[s->data.func_def.name];
+        bool es_plantilla;
+        std::string firma = firma_funcion(f, es_plantilla);
+        if (!es_plantilla && tipo_fijo(f.retorno)) prototipos += firma + ";\n";
+    }
+
+    std::string codigo = prototipos.empty() ? "" : prototipos + "\n";
+    for (AST* s : sentencias) {
+        if (s->type != NODE_FUNC_DEF) continue;
+        const FuncionGen& f = funciones_gen[s->data.func_def.name];
+        bool es_plantilla;
+        std::string firma = firma_funcion(f, es_plantilla);
+        // el interprete deja las variables como estaban al volver de la llamada
+        std::string guardas;
+        for (const std::string& var : f.escritas) {
+            if (!variables_globales.count(var)) continue;
+            usa_restaurar = true;
+            guardas += "_chl_restaurar _chl_guarda_" + var + "(" + var + ");\n";
+        }
+        std::string body_code = generar_cuerpo(s->data.func_def.body);
+        codigo += firma + " {\n" + guardas + body_code + "}\n\n";
+    }
     return codigo;
 }
 
+// Literal de lista; es de flotantes si algun elemento lo es o si se pide
+static std::string generate_list_literal(AST* tree, bool forzar_float) {
+    usa_listas = true;
+    bool es_float = forzar_float || tipo_expr(tree) == TG_LISTA_REAL;
+    std::string code = es_float ? "vector<float>{" : "vector<int32_t>{";
+    for (size_t i = 0; i < tree->data.lista.elementos->size(); i++) {
+        if (i > 0) code += ", ";
+        std::string elem = generate_code_main(tree->data.lista.elementos->at(i));
+        code += es_float ? "float(" + elem + ")" : "int32_t(" + elem + ")";
+    }
+    return code + "}";
+}
+
+// segun_la_wa: con una clave int queda como switch (el compilador arma la tabla
+// de saltos); con un texto, o sin un tipo fijo, como una cadena de if sobre la
+// clave evaluada una vez. Una clave de otro tipo fijo nunca coincide.
+static std::string generar_segun(AST* tree) {
+    const TablaSegun* tabla = tree->data.segun.tabla;
+    const std::vector<AST*>& cuerpos = *tree->data.segun.cuerpos;
+    TipoGen t = tipo_expr(tree->data.segun.expr);
+    std::string clave = generate_code_main(tree->data.segun.expr);
+    std::string defecto = generar_sentencia(tree->data.segun.defecto);
+
+    if (t == TG_ENTERO) {
+        std::string code = "switch (" + clave + ") {\n";
+        for (const auto& [k, caso] : tabla->enteros)
+            code += "case " + std::to_string(k) + ": {\n" + generar_sentencia(cuerpos[caso]) + "break;\n}\n";
+        if (!defecto.empty()) code += "default: {\n" + defecto + "}\n";
+        return code + "}\n";
+    }
+
+    std::vector<std::pair<std::string, int>> pruebas;
+    if (!tipo_fijo(t)) {
+        for (const auto& [k, caso] : tabla->enteros) pruebas.push_back({std::to_string(k), caso});
+    }
+    if (t == TG_TEXTO || !tipo_fijo(t)) {
+        for (const auto& [k, caso] : tabla->textos) pruebas.push_back({literal_texto_cpp(k), caso});
+    }
+    if (pruebas.empty()) return "(void)(" + clave + ");\n" + defecto;
+
+    std::string code = "{\nconst auto& _chl_clave = " + clave + ";\n";
+    for (size_t i = 0; i < pruebas.size(); ++i) {
+        code += std::string(i > 0 ? "else " : "") + "if (_chl_clave == " + pruebas[i].first + ") {\n" +
+                generar_sentencia(cuerpos[pruebas[i].second]) + "}\n";
+    }
+    if (!defecto.empty()) code += "else {\n" + defecto + "}\n";
+    return code + "}\n";
+}
+
 std::string generate_code_main(AST* tree, bool in_for_header) {
     if (!tree) return "";
 
     switch (tree->type) {
         case NODE_FUNC_DEF:
             return "";
-        case NODE_SEQ: {
-            return generate_code_main(tree->data.seq.first, in_for_header) + generate_code_main(tree->data.seq.second, in_for_header);
-        }
+        case NODE_SEQ:
+            return generar_sentencia(tree->data.seq.first) + generar_sentencia(tree->data.seq.second);
         case NODE_DECL: {
             std::string tipo = tree->data.decl.tipo;
             std::string nombre = tree->data.decl.nombre;
-            
-            return tipo + " " + nombre + (in_for_header ? "" : ";\n");
+            if (tipo == "lista_int" || tipo == "lista_float") usa_listas = true;
+            if (variables_globales.count(nombre) || declaraciones_elevadas.count(nombre)) return "";
+            return tipo_cpp(tipo) + " " + nombre + "{};\n";
         }
         case NODE_ASSIGN: {
             std::string var = tree->data.bin.left->data.id;
-            std::string expr = generate_code_main(tree->data.bin.right, in_for_header);
+            std::string expr;
+            if (tree->data.bin.right && tree->data.bin.right->type == NODE_LIST)
+                expr = generate_list_literal(tree->data.bin.right, tipos_declarados[var] == "lista_float");
+            else
+                expr = generate_code_main(tree->data.bin.right);
             return var + " = " + expr + (in_for_header ? "" : ";\n");
         }
-        case NODE_PRINT: {
-            
-            if (in_for_header) {
-                return ""; 
-            } else {
-                return generate_print_expr(tree->data.bin.left);
-            }
-        }
+        case NODE_PRINT:
+            return generate_print_expr(tree->data.bin.left);
         case NODE_INPUT: {
+            usa_entrada = true;
             std::string var = tree->data.input.variable->data.id;
-            return "cin >> " + var + ";\n";
+            std::string tipo = tipos_declarados[var];
+            if (tipo != "int" && tipo != "float") tipo = "string";
+            return var + " = _chl_leer_" + tipo + "();\n";
         }
-        case NODE_INT: {
+        case NODE_INT:
             return std::to_string(tree->data.intval);
-        }
-        case NODE_FLOAT: {
-            return std::to_string(tree->data.floatval);
-        }
-        case NODE_STRING: {
-            return "\"" + std::string(tree->data.strval) + "\"";
-        }
-        case NODE_ID: {
+        case NODE_FLOAT:
+            return literal_real(tree->data.floatval);
+        case NODE_STRING:
+            return literal_texto_cpp(tree->data.strval);
+        case NODE_ID:
             return tree->data.id;
-        }
         case NODE_BINOP: {
-            std::string lhs = generate_code_main(tree->data.bin.left, in_for_header);
-            std::string rhs = generate_code_main(tree->data.bin.right, in_for_header);
-            std::string op;
-            switch (tree->op) {
-                case OP_PLUS: op = "+"; break;
-                case OP_MINUS: op = "-"; break;
-                case OP_MULT: op = "*"; break;
-                case OP_DIV: op = "/"; break;
-                case OP_EQ: op = "=="; break;
-                case OP_NEQ: op = "!="; break;
-                case OP_LT: op = "<"; break;
-                case OP_LEQ: op = "<="; break;
-                case OP_GT: op = ">"; break;
-                case OP_GEQ: op = ">="; break;
-                default: op = "/* unknown */";
-            }
-            return "(" + lhs + " " + op + " " + rhs + ")";
+            AST* izq = tree->data.bin.left;
+            AST* der = tree->data.bin.right;
+            TipoGen l = tipo_expr(izq), r = tipo_expr(der);
+            if (tree->op == OP_PLUS && tipo_expr(tree) == TG_TEXTO)
+                return "(" + como_texto(izq) + " + " + como_texto(der) + ")";
+
+            std::string lhs = generate_code_main(izq);
+            std::string rhs = generate_code_main(der);
+            if (tree->op == OP_DIV && es_numerico(l) && es_numerico(r)) {
+                usa_division = true;
+                return "_chl_dividir(" + lhs + ", " + rhs + ")";
+            }
+            if ((tree->op == OP_EQ || tree->op == OP_NEQ) && tipo_fijo(l) && tipo_fijo(r) && l != r) {
+                // un int nunca es igual a un float ni a un string
+                return std::string("((void)(") + lhs + "), (void)(" + rhs + "), " +
+                       (tree->op == OP_EQ ? "false" : "true") + ")";
+            }
+            if (l == TG_ENTERO && r == TG_ENTERO && tree->op != OP_EQ && tree->op != OP_NEQ) {
+                // el interprete opera dos int en float (sobre 2^24 se redondea igual)
+                std::string op = "((float)" + lhs + " " + op_to_str(tree->op) + " (float)" + rhs + ")";
+                return tree->op >= OP_EQ ? op : "int32_t" + op;
+            }
+            return "(" + lhs + " " + op_to_str(tree->op) + " " + rhs + ")";
+        }
+        case NODE_CONCAT: {
+            std::string code = "(";
+            for (size_t i = 0; i < tree->data.concat.partes->size(); i++) {
+                if (i > 0) code += " + ";
+                code += como_texto(tree->data.concat.partes->at(i));
+            }
+            return code + ")";
+        }
+        case NODE_LIST:
+            return generate_list_literal(tree, false);
+        case NODE_INDEX:
+            return generate_code_main(tree->data.index.lista) + "[" + generate_code_main(tree->data.index.indice) + "]";
+        case NODE_INDEX_ASSIGN: {
+            std::string var = tree->data.index.lista->data.id;
+            std::string indice = generate_code_main(tree->data.index.indice);
+            std::string valor = generate_code_main(tree->data.index.valor);
+            return var + "[" + indice + "] = " + valor + (in_for_header ? "" : ";\n");
         }
         case NODE_IF: {
             std::string cond = generate_code_main(tree->data.ctrl.cond);
-            std::string then_branch = generate_code_main(tree->data.ctrl.then_branch);
-            std::string else_branch = tree->data.ctrl.else_branch ? generate_code_main(tree->data.ctrl.else_branch) : "";
-            std::string code = "if (" + cond + ") {\n" + then_branch + "}\n";
+            std::string then_branch = generar_sentencia(tree->data.ctrl.then_branch);
+            std::string else_branch = generar_sentencia(tree->data.ctrl.else_branch);
+            std::string marca_si, marca_no;
+            marcas_probabilidad(tree->sitio, marca_si, marca_no);
+            std::string code = "if (" + cond + ")" + marca_si + " {\n" + then_branch + "}\n";
             if (!else_branch.empty())
-                code += "else {\n" + else_branch + "}\n";
+                code += "else" + marca_no + " {\n" + else_branch + "}\n";
             return code;
         }
+        case NODE_SWITCH:
+            return generar_segun(tree);
         case NODE_WHILE: {
             std::string cond = generate_code_main(tree->data.ctrl.cond);
-            std::string body = generate_code_main(tree->data.ctrl.then_branch);
+            std::string body = generar_sentencia(tree->data.ctrl.then_branch);
             return "while (" + cond + ") {\n" + body + "}\n";
         }
         case NODE_FUNC_CALL: {
             std::string nombre = tree->data.func_call.name;
-            std::string args_code = "";
-            if (tree->data.func_call.args) {
-                for (size_t i = 0; i < tree->data.func_call.args->data.args.values->size(); i++) {
-                    if (i > 0) args_code += ", ";
-                    args_code += generate_code_main(tree->data.func_call.args->data.args.values->at(i));
-                }
+            const Intrinseca* in = intrinseca_de(tree);
+            if (in) {
+                intrinsecas_usadas.insert(in);
+                if (in->usa_listas) usa_listas = true;
+                if (std::string(in->nombre_cpp) == "_chl_texto") usa_concat = true;
+                nombre = in->nombre_cpp;
+            }
+            std::string args_code;
+            const std::vector<AST*>& args = argumentos(tree);
+            for (size_t i = 0; i < args.size(); i++) {
+                if (i > 0) args_code += ", ";
+                args_code += generate_code_main(args[i]);
             }
-            return nombre + "(" + args_code + ")" + ";\n";
+            // siempre es una expresion; generar_sentencia agrega el ';' si va sola
+            return nombre + "(" + args_code + ")";
         }
         case NODE_RETURN: {
             std::string expr = generate_code_main(tree->data.ret.expr);
             return "return " + expr + ";\n";
         }
         case NODE_FOR: {
-            std::string var_name = "i";  
-
-            std::string init = generate_code_main(tree->data.for_loop.init, true);
-            std::string cond = generate_code_main(tree->data.for_loop.cond, true);
-            std::string post = generate_code_main(tree->data.for_loop.update, true);
-
-            auto replace_init_var = [&](std::string& str, const std::string& new_var) {
-                
-                size_t pos = str.find("int ");
-                if (pos != std::string::npos) {
-                    pos += 4; 
-                    size_t end_pos = str.find_first_of("= ;", pos);
-                    if (end_pos != std::string::npos) {
-                        str.replace(pos, end_pos - pos, new_var);
-                    }
-                }
-            };
-
-            replace_init_var(init, var_name);
-
-            
-            auto replace_var = [&](std::string& str, const std::string& from, const std::string& to) {
-                size_t pos = 0;
-                while ((pos = str.find(from, pos)) != std::string::npos) {
-                   
-                    bool valid = true;
-                    if (pos > 0) {
-                        char before = str[pos - 1];
-                        if ((before >= 'a' && before <= 'z') || (before >= 'A' && before <= 'Z') || (before >= '0' && before <= '9') || before == '_')
-                            valid = false;
-                    }
-                    if (pos + from.size() < str.size()) {
-                        char after = str[pos + from.size()];
-                        if ((after >= 'a' && after <= 'z') || (after >= 'A' && after <= 'Z') || (after >= '0' && after <= '9') || after == '_')
-                            valid = false;
-                    }
-                    if (valid) {
-                        str.replace(pos, from.size(), to);
-                        pos += to.size();
-                    } else {
-                        pos += from.size();
-                    }
+            // la variable del ciclo se declara antes (sigue visible despues del ciclo);
+            // en la cabecera quedan las asignaciones
+            std::vector<AST*> inicio;
+            aplanar(tree->data.for_loop.init, inicio);
+            std::string antes, init;
+            bool solo_asignaciones = true;
+            for (AST* s : inicio)
+                if (s->type != NODE_DECL && s->type != NODE_ASSIGN) solo_asignaciones = false;
+            for (AST* s : inicio) {
+                if (s->type == NODE_DECL || !solo_asignaciones) {
+                    antes += generar_sentencia(s);
+                } else {
+                    if (!init.empty()) init += ", ";
+                    init += generate_code_main(s, true);
                 }
-            };
-
-            replace_var(cond, "i", var_name);
-            replace_var(post, "i", var_name);
-
-            std::string body = generate_code_main(tree->data.for_loop.body);
-            return "for (" + init + "; " + cond + "; " + post + ") {\n" + body + "}\n";
+            }
+            std::string cond = generate_code_main(tree->data.for_loop.cond);
+            std::string post = generate_code_main(tree->data.for_loop.update, true);
+            std::string body = generar_sentencia(tree->data.for_loop.body);
+            return antes + "for (" + init + "; " + cond + "; " + post + ") {\n" + body + "}\n";
         }
 
-
+        case NODE_FOTO:
+            return ""; // la foto es del interprete
         default:
             return "/* Nodo no implementado */\n";
     }
 }
 
-void gen_print_parts(AST* node, std::string& codigo) {
-    if (!node) return;
-
-    if (node->type == NODE_BINOP && node->op == OP_PLUS) {
+// Partes de un texto que se imprime: van una por una a cout, sin armar el string
+static void gen_print_parts(AST* node, std::string& codigo) {
+    if (node->type == NODE_CONCAT) {
+        for (AST* parte : *(node->data.concat.partes)) gen_print_parts(parte, codigo);
+    } else if (node->type == NODE_BINOP && node->op == OP_PLUS && tipo_expr(node) == TG_TEXTO) {
         gen_print_parts(node->data.bin.left, codigo);
         gen_print_parts(node->data.bin.right, codigo);
-    } else {
+    } else if (tipo_expr(node) == TG_TEXTO) {
         codigo += " << " + generate_code_main(node);
+    } else {
+        usa_concat = true;
+        codigo += " << _chl_texto(" + generate_code_main(node) + ")";
     }
 }
 
 std::string generate_print_expr(AST* expr) {
     if (!expr) return "";
 
-    if (expr->type == NODE_BINOP && expr->op == OP_PLUS) {
-        std::string codigo = "cout";
+    std::string codigo = "cout";
+    if (tipo_expr(expr) == TG_TEXTO)
         gen_print_parts(expr, codigo);
-        return codigo + ";\n";
-    } else {
-        return "cout << " + generate_code_main(expr) + ";\n";
-    }
-}
\ No newline at end of file
+    else
+        codigo += " << " + generate_code_main(expr);
+    return codigo + " << '\\n';\n";
+}
@@ -1,9 +1,12 @@
 #ifndef AST_H
 #define AST_H
 
+#include <map>
 #include <string>
 #include <vector>
 #include <variant>
+#include <memory>
+#include <iosfwd>
 
 enum NodeType {
     NODE_INT,
@@ -23,7 +26,13 @@ enum NodeType {
     NODE_PARAMS,
     NODE_RETURN,
     NODE_DECL,
-    NODE_INPUT  
+    NODE_INPUT,
+    NODE_CONCAT,
+    NODE_LIST,
+    NODE_INDEX,
+    NODE_INDEX_ASSIGN,
+    NODE_SWITCH,
+    NODE_FOTO   // foto_la_wa: hasta aqui llega la foto de --foto-grabar (foto.h)
 };
 
 enum BinOp {
@@ -39,24 +48,32 @@ enum BinOp {
     OP_GEQ
 };
 
+struct Lista;      // definida en listas.h
+struct Intrinseca; // definida en intrinsecas.h
+struct TablaSegun; // definida en segun.h
+
 struct Value {
-    enum Type { INT, FLOAT, STRING, NONE } type;
-    std::variant<int, float, std::string> val;
+    enum Type { INT, FLOAT, STRING, LIST, NONE } type;
+    std::variant<int, float, std::string, std::shared_ptr<Lista>> val;
 
     Value() : type(NONE) {}
     Value(int v) : type(INT), val(v) {}
     Value(float v) : type(FLOAT), val(v) {}
     Value(const std::string& v) : type(STRING), val(v) {}
+    Value(std::string&& v) : type(STRING), val(std::move(v)) {}
+    Value(std::shared_ptr<Lista> v) : type(LIST), val(std::move(v)) {}
 
     int asInt() const { return std::get<int>(val); }
     float asFloat() const { return std::get<float>(val); }
     std::string asString() const { return std::get<std::string>(val); }
+    const std::shared_ptr<Lista>& asList() const { return std::get<std::shared_ptr<Lista>>(val); }
 };
 
 struct AST {
     NodeType type;
     int op;
     double value;
+    int sitio = -1; // numero de si_po, ciclo o llamada para el perfil de --pgo (pgo.h)
 
     union {
         int intval;
@@ -89,6 +106,7 @@ struct AST {
         struct {
             char* name;
             AST* args;
+            const Intrinseca* intrinseca; // resuelta por el optimizador, o nullptr
         } func_call;
 
         struct {
@@ -118,6 +136,30 @@ struct AST {
         struct {
             AST* variable; 
         } input;
+
+        struct {
+            std::vector<AST*>* partes;
+        } concat;
+
+        struct {
+            std::vector<AST*>* elementos;
+        } lista;
+
+        struct {
+            AST* lista;
+            AST* indice;
+            AST* valor;
+        } index;
+
+        struct {
+            AST* expr;
+            std::vector<AST*>* claves;  // NODE_INT o NODE_STRING, una por caso
+            std::vector<AST*>* cuerpos;
+            AST* defecto;               // si_no_po, o nullptr
+            const TablaSegun* tabla;
+            // viene de si_po seguidos: como en la secuencia, solo el ultimo caso da valor
+            bool valor_del_ultimo;
+        } segun;
     } data;
 };
 
@@ -139,14 +181,71 @@ AST* make_return(AST* expr);
 AST* make_for(AST* init, AST* cond, AST* update, AST* body);
 AST* make_decl(const char* tipo, const char* nombre);
 AST* make_input(AST* variable); 
+AST* make_concat(std::vector<AST*>* partes);
+AST* make_list(std::vector<AST*>* elementos);
+AST* make_index(AST* lista, AST* indice);
+AST* make_index_assign(AST* lista, AST* indice, AST* valor);
+// casos: clave y cuerpo de cada caso, alternados (como los arma el parser)
+AST* make_segun(AST* expr, std::vector<AST*>* casos, AST* defecto);
+AST* make_foto();
+
+// Punteros a los hijos de un nodo (los que pueden ser nullptr tambien se incluyen)
+std::vector<AST**> ast_hijos(AST* tree);
+
+// optimizacion del arbol antes de evaluar y generar codigo
+AST* optimizar_ast(AST* tree);
+AST* optimizar_llamadas(AST* tree);
+AST* optimizar_segun(AST* tree);
+
+// Limites del inlining: tamano maximo (en nodos) de la funcion y cantidad maxima
+// de llamadas reemplazadas por funcion. Con inline_max_nodos = 0 no se hace inline.
+extern int inline_max_nodos;
+extern int inline_max_sitios;
+// Escribe en stderr que funciones se hicieron inline, cuales se eliminaron y
+// que cadenas de si_po quedaron como segun
+extern bool reporte_optimizador;
 
 //funciones para imprimir y evaluar el arbol
+const char* op_to_str(int op);
 void print_ast(AST* tree, int indent = 0);
 Value eval_ast(AST* tree);
 
+// Semantica de los valores, compartida por el interprete del arbol y el de la IR
+bool es_verdadero(const Value& v);
+Value operar_binop(int op, const Value& lhs, const Value& rhs);
+Value valor_para_asignar(const std::string& tipo, const Value& val, const std::string& var);
+Value leer_entrada(const std::string& tipo, const std::string& var);
+void imprimir_valor(const Value& val);
+void imprimir_partes(const Value* valores, size_t n);
+// Por defecto lee_la_wa lee una linea de stdin y suelta_la_wa escribe en stdout.
+// Son por hilo: --lote (lote.h) les da a sus hilos la fila y un buffer por registro.
+extern thread_local std::ostream* salida_programa;
+extern thread_local void (*fuente_entrada)(const std::string& var, std::string& linea);
+// Olvida las variables y funciones del interprete de este hilo
+void reiniciar_interprete();
+
+// Tablas del interprete del hilo actual; la foto (foto.h) las guarda y restaura
+struct VarInfo {
+    std::string tipo; // "int", "float", "string"
+    Value valor;
+};
+std::map<std::string, VarInfo>& variables_interprete();
+// nombre -> (cuerpo, parametros)
+std::map<std::string, std::pair<AST*, std::vector<std::string>>>& funciones_interprete();
+// Estimacion de los bytes de las variables visibles (como en --mem-stats)
+size_t bytes_variables_interprete();
+Value concatenar_partes(const Value* valores, size_t n);
+Value crear_lista(const Value* valores, size_t n);
+Value indexar_lista(const Value& lista, const Value& indice);
+
 // funciones para generación de código
-std::string generar_programa(AST* tree);         
+// Devuelve false (con el motivo) si el programa no se puede escribir en C++
+bool generar_programa(AST* tree, std::string& codigo, std::string& motivo);
 std::string generate_code_funcs(AST* tree);
 std::string generate_print_expr(AST* expr);
 std::string generate_code_main(AST* tree, bool in_for_header = false);
+// Partes del C++ generado que tambien usa el generador de la IR
+std::string prelude_entrada();
+std::string inicio_main(bool lee_entrada, const std::string& sangria = "");
+void marcas_probabilidad(int sitio, std::string& marca_si, std::string& marca_no);
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#!/bin/bash
+# Compara el tiempo de ejecucion del interprete con el del C++ generado.
+# Uso (desde la raiz del repositorio, con chileno_compilador ya compilado):
+#   ./benchmark/benchmark.sh [opciones del compilador] [programas...]
+# Sin programas se usan los de benchmark/. CXX y CXXFLAGS eligen el compilador
+# de C++ (por defecto g++ -O2 -std=c++17).
+
+compilador="$(pwd)/chileno_compilador"
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2 -std=c++17}
+
+opciones=()
+programas=()
+for arg in "$@"; do
+    case "$arg" in
+        --*) opciones+=("$arg") ;;
+        *) programas+=("$(realpath "$arg")") ;;
+    esac
+done
+if [ ${#programas[@]} -eq 0 ]; then
+    programas=("$(pwd)"/benchmark/*.txt)
+fi
+
+if [ ! -x "$compilador" ]; then
+    echo "No se encontro $compilador" >&2
+    exit 1
+fi
+
+ms() { echo $(( $(date +%s%N) / 1000000 )); }
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+cd "$dir"
+
+printf "%-20s %12s %12s %10s  %s\n" "programa" "interprete" "C++" "veces" "salida"
+for prog in "${programas[@]}"; do
+    nombre=$(basename "$prog" .txt)
+
+    # el interprete escribe el arbol y el C++ ademas de la salida del programa
+    inicio=$(ms)
+    "$compilador" "${opciones[@]}" "$prog" < /dev/null > completo.txt 2> /dev/null
+    t_interprete=$(( $(ms) - inicio ))
+    sed -n '/^--- Ejecucion del programa ---$/,/^--- Generando codigo C++ ---$/p' completo.txt | sed '1d;$d' | sed '$d' > interprete.txt
+
+    if ! $CXX $CXXFLAGS -o programa cpp_chileno.cpp 2> compilacion.txt; then
+        printf "%-20s %10s ms %12s %10s  %s\n" "$nombre" "$t_interprete" "-" "-" "no compila"
+        continue
+    fi
+    inicio=$(ms)
+    ./programa < /dev/null > generado.txt
+    t_cpp=$(( $(ms) - inicio ))
+
+    salida="igual"
+    cmp -s interprete.txt generado.txt || salida="distinta"
+    veces=$(awk -v a="$t_interprete" -v b="$t_cpp" 'BEGIN { printf "%.1f", a / (b > 0 ? b : 1) }')
+    printf "%-20s %10s ms %9s ms %9sx  %s\n" "$nombre" "$t_interprete" "$t_cpp" "$veces" "$salida"
+done
@@ -12,14 +12,25 @@
 #include <string>
 #include <map>
 #include "ast.h"
+#include "memoria.h"
+#include "perfil.h"
+#include "pgo.h"
+#include "ir.h"
+#include "lote.h"
+#include "foto.h"
+#include "presupuesto.h"
+#include "planificador.h"
+#include <deque>
 #include <fstream>
+#include <cstring>
 
 extern int yylex();
 void yyerror(const char* s) { std::cerr << "Error: " << s << std::endl; exit(1); }
 extern FILE* yyin;
+extern void yyrestart(FILE* f);
 AST* tree;
 
-std::string generar_programa(AST* root);
+bool generar_programa(AST* root, std::string& codigo, std::string& motivo);
 
 std::map<std::string, bool> tabla_simbolos;  // Guarda variables declaradas
 %}
@@ -36,10 +47,19 @@ std::map<std::string, bool> tabla_simbolos;  // Guarda variables declaradas
 %token <intval> NUM
 %token <strval> ID STRING
 %token <floatval> FLOAT
-%token IF ELSE WHILE PRINT FUNCTION RETURN EQ FOR NEQ LEQ GEQ TIPO_INT TIPO_FLOAT TIPO_STRING LEE
+%token IF ELSE WHILE PRINT FUNCTION RETURN EQ FOR NEQ LEQ GEQ TIPO_INT TIPO_FLOAT TIPO_STRING TIPO_LISTA_INT TIPO_LISTA_FLOAT LEE SEGUN CASO FOTO
 
-%type <ast> expr stmt stmts program func_def func_call return_stmt decl
-%type <astlist> arg_list
+// Todos los operadores binarios tienen el mismo nivel y agrupan a la derecha
+// (a - b * c es a - (b * c), y a * b - c es a * (b - c)); el lado derecho de
+// una asignacion, tambien de xs[i] = ..., llega hasta el final de la expresion.
+// Es lo que bison hacia por defecto en cada conflicto. El unico conflicto que
+// queda es el si_no_po colgante, que se asocia con el si_po mas cercano.
+%right '='
+%right EQ NEQ '<' '>' LEQ GEQ '+' '-' '*' '/'
+%expect 1
+
+%type <ast> expr stmt stmts program func_def func_call return_stmt decl clave
+%type <astlist> arg_list casos
 %type <strlist> param_list
 
 %%
@@ -60,12 +80,17 @@ stmt
     | IF '(' expr ')' stmt ELSE stmt
                                  { $$ = make_if($3, $5, $7); }
     | WHILE '(' expr ')' stmt    { $$ = make_while($3, $5); }
+    | SEGUN '(' expr ')' '{' casos '}'
+                                 { $$ = make_segun($3, $6, nullptr); }
+    | SEGUN '(' expr ')' '{' casos ELSE stmt '}'
+                                 { $$ = make_segun($3, $6, $8); }
     | FOR '(' decl ';' expr ';' expr ')' stmt  
                                  { $$ = make_for($3, $5, $7, $9); }
     | '{' stmts '}'              { $$ = $2; }
     | func_def                   { $$ = $1; }
     | return_stmt                { $$ = $1; }
     | decl ';'                   { $$ = $1; }
+    | FOTO ';'                   { $$ = make_foto(); }
     | LEE ID ';'                 { 
                                     if (tabla_simbolos.count($2) == 0) {
                                         std::cerr << "Error: variable '" << $2 << "' no declarada para input\n";
@@ -124,6 +149,50 @@ decl
                                   tabla_simbolos[$2] = true;
                                   $$ = make_seq(make_decl("string", $2), make_assign(make_id($2), $4));
                                 }
+    | TIPO_LISTA_INT ID          {
+                                  if (tabla_simbolos.count($2)) {
+                                    std::cerr << "Error: variable '" << $2 << "' ya declarada\n";
+                                    exit(1);
+                                  }
+                                  tabla_simbolos[$2] = true;
+                                  $$ = make_decl("lista_int", $2);
+                                }
+    | TIPO_LISTA_INT ID '=' expr {
+                                  if (tabla_simbolos.count($2)) {
+                                    std::cerr << "Error: variable '" << $2 << "' ya declarada\n";
+                                    exit(1);
+                                  }
+                                  tabla_simbolos[$2] = true;
+                                  $$ = make_seq(make_decl("lista_int", $2), make_assign(make_id($2), $4));
+                                }
+    | TIPO_LISTA_FLOAT ID        {
+                                  if (tabla_simbolos.count($2)) {
+                                    std::cerr << "Error: variable '" << $2 << "' ya declarada\n";
+                                    exit(1);
+                                  }
+                                  tabla_simbolos[$2] = true;
+                                  $$ = make_decl("lista_float", $2);
+                                }
+    | TIPO_LISTA_FLOAT ID '=' expr
+                                {
+                                  if (tabla_simbolos.count($2)) {
+                                    std::cerr << "Error: variable '" << $2 << "' ya declarada\n";
+                                    exit(1);
+                                  }
+                                  tabla_simbolos[$2] = true;
+                                  $$ = make_seq(make_decl("lista_float", $2), make_assign(make_id($2), $4));
+                                }
+    ;
+
+casos
+    : CASO clave ':' stmt        { $$ = new std::vector<AST*>({$2, $4}); }
+    | casos CASO clave ':' stmt  { $1->push_back($3); $1->push_back($5); $$ = $1; }
+    ;
+
+clave
+    : NUM                        { $$ = make_int($1); }
+    | '-' NUM                    { $$ = make_int(-$2); }
+    | STRING                     { $$ = make_string($1); }
     ;
 
 return_stmt
@@ -184,6 +253,21 @@ expr
                                   }
                                   $$ = make_assign(make_id($1), $3);
                                 }
+    | ID '[' expr ']'            {
+                                  if (tabla_simbolos.count($1) == 0) {
+                                    std::cerr << "Error sintactico: variable '" << $1 << "' no declarada\n";
+                                    exit(1);
+                                  }
+                                  $$ = make_index(make_id($1), $3);
+                                }
+    | ID '[' expr ']' '=' expr   {
+                                  if (tabla_simbolos.count($1) == 0) {
+                                    std::cerr << "Error sintactico: variable '" << $1 << "' no declarada para asignacion.\n";
+                                    exit(1);
+                                  }
+                                  $$ = make_index_assign(make_id($1), $3, $6);
+                                }
+    | '[' arg_list ']'           { $$ = make_list($2); }
     | func_call                  { $$ = $1; }
     | '(' expr ')'               { $$ = $2; }
     ;
@@ -200,34 +284,266 @@ arg_list
 
 %%
 
+// --planificar: cada programa se parsea y optimiza por separado y despues se
+// ejecutan todos a la vez. Devuelve 2 si alguno se detuvo por un limite.
+static int planificar_programas(const std::vector<const char*>& archivos, int trabajadores, long long turno,
+                                const LimitesEjecucion& limites) {
+    std::vector<ProgramaPlanificado> programas;
+    std::deque<ProgramaIR> irs;
+    for (size_t i = 0; i < archivos.size(); ++i) {
+        FILE* f = fopen(archivos[i], "r");
+        if (!f) {
+            std::cerr << "No se pudo abrir el archivo: " << archivos[i] << std::endl;
+            return 1;
+        }
+        yyin = f;
+        if (i > 0) yyrestart(f);
+        tabla_simbolos.clear();
+        if (yyparse() != 0) {
+            std::cerr << "Error durante el parseo de " << archivos[i] << ".\n";
+            return 1;
+        }
+        fclose(f);
+
+        AST* programa = optimizar_ast(tree);
+        const ProgramaIR* ir = nullptr;
+        if (usar_ir) {
+            std::string motivo;
+            ProgramaIR& nueva = irs.emplace_back();
+            if (construir_ir(programa, nueva, motivo)) {
+                optimizar_ir(nueva);
+                ir = &nueva;
+            } else {
+                std::cerr << "IR: no se usa en " << archivos[i] << " (" << motivo << "), se interpreta el arbol\n";
+            }
+        }
+        programas.push_back({archivos[i], programa, ir});
+    }
+    return planificar(programas, trabajadores, turno, limites) > 0 ? 2 : 0;
+}
+
+// Uso del compilador, con --help o si falta el archivo
+static void imprimir_uso(std::ostream& out) {
+    out << "Uso: ./chileno_compilador [--mem-stats[=json]] [--perfil=salida.folded [--perfil-intervalo=us]] [--pgo-grabar=perfil.pgo] [--pgo-usar=perfil.pgo] [--lote=registros.csv [--lote-hilos=n]] [--foto-grabar=inicio.foto | --foto-usar=inicio.foto] [--limite-pasos=n] [--limite-tiempo=ms] [--limite-memoria=kb] [--planificar=n [--turno=pasos]] [--inline-max-nodos=n] [--inline-max-sitios=n] [--reporte-optimizador] [--ir] [--dump-ir] [--help] archivo.chileno.txt [mas archivos con --planificar]\n";
+    out << "  --planificar=n: a lo mas n programas avanzan a la vez; no limita los hilos (uno por programa)\n";
+}
+
 int main(int argc, char** argv) {
-    if (argc > 1) {
-        FILE* f = fopen(argv[1], "r");
+    const char* archivo = nullptr;
+    std::vector<const char*> archivos;
+    bool mem_json = false;
+    const char* archivo_perfil = nullptr;
+    long intervalo_perfil = PERFIL_INTERVALO_US;
+    const char* pgo_grabar = nullptr;
+    const char* pgo_usar = nullptr;
+    const char* archivo_lote = nullptr;
+    int hilos_lote = 0;
+    const char* foto_grabar_en = nullptr;
+    const char* foto_usar_de = nullptr;
+    LimitesEjecucion limites;
+    int trabajadores = 0;
+    long long turno = PLANIFICADOR_TURNO;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--mem-stats") == 0) {
+            memoria_activa = true;
+        } else if (strcmp(argv[i], "--mem-stats=json") == 0) {
+            memoria_activa = true;
+            mem_json = true;
+        } else if (strncmp(argv[i], "--perfil=", 9) == 0) {
+            archivo_perfil = argv[i] + 9;
+        } else if (strncmp(argv[i], "--perfil-intervalo=", 19) == 0) {
+            intervalo_perfil = atol(argv[i] + 19);
+            if (intervalo_perfil <= 0) {
+                std::cerr << "Error: el intervalo del perfil debe ser positivo (microsegundos)\n";
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--pgo-grabar=", 13) == 0) {
+            pgo_grabar = argv[i] + 13;
+        } else if (strncmp(argv[i], "--pgo-usar=", 11) == 0) {
+            pgo_usar = argv[i] + 11;
+        } else if (strncmp(argv[i], "--lote=", 7) == 0) {
+            archivo_lote = argv[i] + 7;
+        } else if (strncmp(argv[i], "--lote-hilos=", 13) == 0) {
+            hilos_lote = atoi(argv[i] + 13);
+            if (hilos_lote <= 0) {
+                std::cerr << "Error: la cantidad de hilos del lote debe ser positiva\n";
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--foto-grabar=", 14) == 0) {
+            foto_grabar_en = argv[i] + 14;
+        } else if (strncmp(argv[i], "--foto-usar=", 12) == 0) {
+            foto_usar_de = argv[i] + 12;
+        } else if (strncmp(argv[i], "--limite-pasos=", 15) == 0) {
+            limites.pasos = atoll(argv[i] + 15);
+            if (limites.pasos <= 0) {
+                std::cerr << "Error: el limite de pasos debe ser positivo\n";
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--limite-tiempo=", 16) == 0) {
+            limites.segundos = atof(argv[i] + 16) / 1000;
+            if (limites.segundos <= 0) {
+                std::cerr << "Error: el limite de tiempo debe ser positivo (milisegundos)\n";
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--limite-memoria=", 17) == 0) {
+            long long kb = atoll(argv[i] + 17);
+            if (kb <= 0) {
+                std::cerr << "Error: el limite de memoria debe ser positivo (KB)\n";
+                return 1;
+            }
+            limites.bytes = (size_t)kb * 1024;
+        } else if (strncmp(argv[i], "--planificar=", 13) == 0) {
+            trabajadores = atoi(argv[i] + 13);
+            if (trabajadores <= 0) {
+                std::cerr << "Error: la cantidad de trabajadores debe ser positiva\n";
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--turno=", 8) == 0) {
+            turno = atoll(argv[i] + 8);
+            if (turno <= 0) {
+                std::cerr << "Error: el turno debe ser de al menos un paso\n";
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--inline-max-nodos=", 19) == 0) {
+            inline_max_nodos = atoi(argv[i] + 19);
+        } else if (strncmp(argv[i], "--inline-max-sitios=", 20) == 0) {
+            inline_max_sitios = atoi(argv[i] + 20);
+        } else if (strcmp(argv[i], "--reporte-optimizador") == 0) {
+            reporte_optimizador = true;
+        } else if (strcmp(argv[i], "--ir") == 0) {
+            usar_ir = true;
+        } else if (strcmp(argv[i], "--dump-ir") == 0) {
+            usar_ir = true;
+            dump_ir = true;
+        } else if (strcmp(argv[i], "--help") == 0) {
+            imprimir_uso(std::cout);
+            return 0;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            std::cerr << "Opcion desconocida: " << argv[i] << std::endl;
+            return 1;
+        } else {
+            if (!archivo) archivo = argv[i];
+            archivos.push_back(argv[i]);
+        }
+    }
+
+    if (archivos.size() > 1 && !trabajadores) {
+        std::cerr << "Error: solo se ejecuta un programa a la vez (varios con --planificar)\n";
+        return 1;
+    }
+    if (trabajadores && archivo) {
+        if (archivo_lote || foto_grabar_en || foto_usar_de || archivo_perfil || pgo_grabar || pgo_usar ||
+            memoria_activa) {
+            std::cerr << "Error: --planificar no se puede usar con --lote, --foto-*, --perfil, --pgo-* ni --mem-stats\n";
+            return 1;
+        }
+        return planificar_programas(archivos, trabajadores, turno, limites);
+    }
+
+    if (archivo) {
+        FILE* f = fopen(archivo, "r");
         if (!f) {
-            std::cerr << "No se pudo abrir el archivo: " << argv[1] << std::endl;
+            std::cerr << "No se pudo abrir el archivo: " << archivo << std::endl;
             return 1;
         }
         yyin = f;
     } else {
-        std::cerr << "Uso: ./chileno_compilador archivo.chileno.txt\n";
+        imprimir_uso(std::cerr);
         return 1;
     }
+    // el interprete cuenta perfil, pgo y memoria en variables globales sin sincronizar
+    if (archivo_lote && (archivo_perfil || pgo_grabar || memoria_activa)) {
+        std::cerr << "Error: --lote no se puede usar con --perfil, --pgo-grabar ni --mem-stats\n";
+        return 1;
+    }
+    // la foto es del interprete del arbol: la IR no usa la tabla de variables
+    if ((foto_grabar_en || foto_usar_de) &&
+        (usar_ir || archivo_lote || limites.activos() || (foto_grabar_en && foto_usar_de))) {
+        std::cerr << "Error: --foto-grabar y --foto-usar no se pueden combinar entre ellas ni con --ir, --lote o --limite-*\n";
+        return 1;
+    }
+
+    memoria_inicio_fase("parseo");
+    int resultado_parseo = yyparse();
+    memoria_fin_fase();
 
-    if (yyparse() == 0) {
-        std::cout << "--- Arbol de sintaxis generado ---\n";
-        print_ast(tree, 0);
+    if (resultado_parseo == 0) {
+        memoria_contar_arbol("parseo", tree);
+
+        // en modo lote la salida es solo la de los registros
+        if (!archivo_lote) {
+            std::cout << "--- Arbol de sintaxis generado ---\n";
+            print_ast(tree, 0);
+        }
+
+        // los sitios del perfil se numeran antes de optimizar
+        pgo_numerar(tree);
+        if (pgo_usar && !pgo_cargar(pgo_usar)) return 1;
+        pgo_grabando = pgo_grabar != nullptr;
+
+        memoria_inicio_fase("optimizacion");
+        tree = optimizar_ast(tree);
+        memoria_fin_fase();
+        memoria_contar_arbol("optimizado", tree);
+
+        ProgramaIR ir;
+        bool con_ir = false;
+        if (usar_ir) {
+            memoria_inicio_fase("ir");
+            std::string motivo;
+            if (dump_ir) std::cout << "\n";
+            con_ir = construir_ir(tree, ir, motivo);
+            if (con_ir)
+                optimizar_ir(ir);
+            else
+                std::cerr << "IR: no se usa (" << motivo << "), se interpreta el arbol\n";
+            memoria_fin_fase();
+        }
+
+        if (archivo_lote)
+            return ejecutar_lote(archivo_lote, hilos_lote, tree, con_ir ? &ir : nullptr, limites) ? 0 : 1;
 
         std::cout << "\n--- Ejecucion del programa ---\n";
-        eval_ast(tree); 
+        memoria_inicio_fase("ejecucion");
+        ResultadoEjecucion resultado;
+        if (archivo_perfil && !perfil_iniciar(intervalo_perfil)) return 1;
+        if (foto_grabar_en) {
+            if (!foto_grabar(tree, foto_grabar_en)) return 1;
+        } else if (foto_usar_de) {
+            if (!foto_usar(tree, foto_usar_de)) return 1;
+        } else {
+            resultado = ejecutar_con_limites(tree, con_ir ? &ir : nullptr, limites);
+        }
+        // la salida del programa puede haber quedado a medias: el resultado va aparte, en stderr
+        if (limites.activos()) std::cerr << resultado_json(resultado) << "\n";
+        if (archivo_perfil) perfil_escribir(archivo_perfil);
+        if (pgo_grabar && !pgo_escribir(pgo_grabar)) return 1;
+        memoria_fin_fase();
 
         
         std::cout << "\n--- Generando codigo C++ ---\n";
-        std::string codigo_cpp = generar_programa(tree);
+        memoria_inicio_fase("generacion");
+        std::string codigo_cpp, motivo_cpp;
+        if (!con_ir || !generar_programa_ir(ir, codigo_cpp, motivo_cpp)) {
+            if (con_ir) std::cerr << "IR: C++ generado desde el arbol (" << motivo_cpp << ")\n";
+            if (!generar_programa(tree, codigo_cpp, motivo_cpp)) {
+                // no se deja un cpp_chileno.cpp de otro programa
+                std::remove("cpp_chileno.cpp");
+                std::cerr << "Error: no se puede generar C++ (" << motivo_cpp << ")\n";
+                return 1;
+            }
+        }
         std::ofstream out("cpp_chileno.cpp");
         out << codigo_cpp;
         out.close();
+        memoria_fin_fase();
         std::cout << "Archivo generado: cpp_chileno.cpp\n";
 
+        // el reporte va a stderr para no mezclarse con la salida del programa
+        if (memoria_activa) memoria_reporte(std::cerr, mem_json);
+        if (resultado.estado != EJECUCION_TERMINADA) return 2;
+
     } else {
         std::cerr << "Error durante el parseo.\n";
         return 1;
@@ -0,0 +1,431 @@
+#include "foto.h"
+#include "listas.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Formato del archivo (enteros en el orden de bytes de la maquina):
+// cabecera, textos, variables, funciones, listas, parametros, numeros y bytes
+// de los textos. Cada nombre, tipo y texto se guarda una sola vez en la tabla
+// de textos y el resto lo nombra por su indice.
+static const char FOTO_MAGIA[8] = {'C', 'H', 'L', 'F', 'O', 'T', 'O', '1'};
+static const uint32_t SIN_CUERPO = UINT32_MAX;
+
+struct CabeceraFoto {
+    char magia[8];
+    uint64_t huella;
+    uint32_t sentencias; // sentencias de arriba ya ejecutadas
+    uint32_t salida;     // texto con lo que imprimieron
+    uint32_t textos;
+    uint32_t variables;
+    uint32_t funciones;
+    uint32_t listas;
+    uint32_t parametros;
+    uint32_t relleno;
+    uint64_t numeros;
+    uint64_t bytes;
+};
+
+struct TextoFoto {
+    uint64_t inicio;
+    uint64_t largo;
+};
+
+struct VariableFoto {
+    uint32_t nombre;
+    uint32_t tipo;
+    uint32_t clase; // Value::Type
+    uint32_t dato;  // el int o float, o el indice del texto o de la lista
+};
+
+struct FuncionFoto {
+    uint32_t nombre;
+    uint32_t cuerpo; // numero del nodo en preorden, o SIN_CUERPO
+    uint32_t primer_parametro;
+    uint32_t parametros;
+};
+
+struct ListaFoto {
+    uint32_t es_float;
+    uint32_t largo;
+    uint64_t inicio; // en numeros
+};
+
+// Huella FNV-1a del arbol: tipos de nodo, nombres y constantes
+static void mezclar(uint64_t& h, const void* datos, size_t n) {
+    const unsigned char* p = (const unsigned char*)datos;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+static void mezclar_texto(uint64_t& h, const char* s) {
+    mezclar(h, s, strlen(s) + 1);
+}
+
+static void huella_nodo(AST* tree, uint64_t& h) {
+    int tipo = tree ? (int)tree->type : -1;
+    mezclar(h, &tipo, sizeof(tipo));
+    if (!tree) return;
+    switch (tree->type) {
+        case NODE_INT: mezclar(h, &tree->data.intval, sizeof(int)); break;
+        case NODE_FLOAT: mezclar(h, &tree->data.floatval, sizeof(float)); break;
+        case NODE_STRING: mezclar_texto(h, tree->data.strval); break;
+        case NODE_ID: mezclar_texto(h, tree->data.id); break;
+        case NODE_BINOP: mezclar(h, &tree->op, sizeof(int)); break;
+        case NODE_DECL:
+            mezclar_texto(h, tree->data.decl.tipo);
+            mezclar_texto(h, tree->data.decl.nombre);
+            break;
+        case NODE_FUNC_DEF: mezclar_texto(h, tree->data.func_def.name); break;
+        case NODE_FUNC_CALL: mezclar_texto(h, tree->data.func_call.name); break;
+        case NODE_PARAMS:
+            if (tree->data.params.names)
+                for (const std::string& p : *tree->data.params.names) mezclar_texto(h, p.c_str());
+            break;
+        default:
+            break;
+    }
+    for (AST** hijo : ast_hijos(tree)) huella_nodo(*hijo, h);
+}
+
+static uint64_t huella(AST* tree) {
+    uint64_t h = 14695981039346656037ULL;
+    huella_nodo(tree, h);
+    return h;
+}
+
+// Nodos en preorden: asi se nombran los cuerpos de las funciones en el archivo
+static void numerar_nodos(AST* tree, std::vector<AST*>& nodos) {
+    if (!tree) return;
+    nodos.push_back(tree);
+    for (AST** hijo : ast_hijos(tree)) numerar_nodos(*hijo, nodos);
+}
+
+static void aplanar(AST* tree, std::vector<AST*>& sentencias) {
+    if (!tree) return;
+    if (tree->type == NODE_SEQ) {
+        aplanar(tree->data.seq.first, sentencias);
+        aplanar(tree->data.seq.second, sentencias);
+    } else {
+        sentencias.push_back(tree);
+    }
+}
+
+static void recolectar_funciones(AST* tree, std::map<std::string, AST*>& cuerpos) {
+    if (!tree) return;
+    if (tree->type == NODE_FUNC_DEF) cuerpos[tree->data.func_def.name] = tree->data.func_def.body;
+    for (AST** hijo : ast_hijos(tree)) recolectar_funciones(*hijo, cuerpos);
+}
+
+// La sentencia llega a un foto_la_wa o a un lee_la_wa, directo o llamando funciones
+static bool detiene(AST* tree, const std::map<std::string, AST*>& cuerpos, std::set<std::string>& vistas) {
+    if (!tree || tree->type == NODE_FUNC_DEF) return false;
+    if (tree->type == NODE_FOTO || tree->type == NODE_INPUT) return true;
+    if (tree->type == NODE_FUNC_CALL && !tree->data.func_call.intrinseca) {
+        auto it = cuerpos.find(tree->data.func_call.name);
+        if (it != cuerpos.end() && vistas.insert(it->first).second && detiene(it->second, cuerpos, vistas))
+            return true;
+    }
+    for (AST** hijo : ast_hijos(tree))
+        if (detiene(*hijo, cuerpos, vistas)) return true;
+    return false;
+}
+
+static size_t punto_de_foto(AST* tree, const std::vector<AST*>& sentencias) {
+    std::map<std::string, AST*> cuerpos;
+    recolectar_funciones(tree, cuerpos);
+    std::set<std::string> vistas;
+    for (size_t i = 0; i < sentencias.size(); ++i)
+        if (detiene(sentencias[i], cuerpos, vistas)) return i;
+    return sentencias.size();
+}
+
+// Foto armada en memoria antes de escribirla
+struct ArmadoFoto {
+    std::vector<TextoFoto> textos;
+    std::string bytes;
+    std::map<std::string, uint32_t> indices;
+    std::vector<VariableFoto> variables;
+    std::vector<FuncionFoto> funciones;
+    std::vector<ListaFoto> listas;
+    std::map<const Lista*, uint32_t> listas_vistas;
+    std::vector<uint32_t> parametros;
+    std::vector<uint32_t> numeros;
+
+    uint32_t texto(const std::string& s) {
+        auto [it, nuevo] = indices.emplace(s, (uint32_t)textos.size());
+        if (nuevo) {
+            textos.push_back({bytes.size(), s.size()});
+            bytes += s;
+        }
+        return it->second;
+    }
+
+    uint32_t lista(const Lista& xs) {
+        auto [it, nueva] = listas_vistas.emplace(&xs, (uint32_t)listas.size());
+        if (nueva) {
+            listas.push_back({xs.es_float, (uint32_t)xs.largo(), numeros.size()});
+            const void* datos = xs.es_float ? (const void*)xs.flotantes.data() : (const void*)xs.enteros.data();
+            size_t n = numeros.size();
+            numeros.resize(n + xs.largo());
+            memcpy(numeros.data() + n, datos, xs.largo() * sizeof(uint32_t));
+        }
+        return it->second;
+    }
+
+    uint32_t dato(const Value& v) {
+        uint32_t d = 0;
+        switch (v.type) {
+            case Value::INT: { int i = v.asInt(); memcpy(&d, &i, sizeof(d)); break; }
+            case Value::FLOAT: { float f = v.asFloat(); memcpy(&d, &f, sizeof(d)); break; }
+            case Value::STRING: d = texto(std::get<std::string>(v.val)); break;
+            case Value::LIST: d = lista(*v.asList()); break;
+            default: break;
+        }
+        return d;
+    }
+};
+
+template <typename T>
+static void escribir_tabla(std::ofstream& out, const std::vector<T>& tabla) {
+    out.write((const char*)tabla.data(), tabla.size() * sizeof(T));
+}
+
+static bool escribir_foto(const char* archivo, AST* tree, size_t sentencias, const std::string& salida) {
+    ArmadoFoto foto;
+    for (const auto& [nombre, info] : variables_interprete())
+        foto.variables.push_back({foto.texto(nombre), foto.texto(info.tipo), (uint32_t)info.valor.type,
+                                  foto.dato(info.valor)});
+
+    std::vector<AST*> nodos;
+    numerar_nodos(tree, nodos);
+    std::unordered_map<AST*, uint32_t> numero;
+    for (size_t i = 0; i < nodos.size(); ++i) numero[nodos[i]] = (uint32_t)i;
+    for (const auto& [nombre, funcion] : funciones_interprete()) {
+        auto it = numero.find(funcion.first);
+        FuncionFoto f = {foto.texto(nombre), it != numero.end() ? it->second : SIN_CUERPO,
+                         (uint32_t)foto.parametros.size(), (uint32_t)funcion.second.size()};
+        for (const std::string& p : funcion.second) foto.parametros.push_back(foto.texto(p));
+        foto.funciones.push_back(f);
+    }
+
+    CabeceraFoto cabecera = {};
+    memcpy(cabecera.magia, FOTO_MAGIA, sizeof(FOTO_MAGIA));
+    cabecera.huella = huella(tree);
+    cabecera.sentencias = (uint32_t)sentencias;
+    cabecera.salida = foto.texto(salida);
+    cabecera.textos = (uint32_t)foto.textos.size();
+    cabecera.variables = (uint32_t)foto.variables.size();
+    cabecera.funciones = (uint32_t)foto.funciones.size();
+    cabecera.listas = (uint32_t)foto.listas.size();
+    cabecera.parametros = (uint32_t)foto.parametros.size();
+    cabecera.numeros = foto.numeros.size();
+    cabecera.bytes = foto.bytes.size();
+
+    std::ofstream out(archivo, std::ios::binary);
+    if (!out) {
+        std::cerr << "No se pudo escribir la foto: " << archivo << std::endl;
+        return false;
+    }
+    out.write((const char*)&cabecera, sizeof(cabecera));
+    escribir_tabla(out, foto.textos);
+    escribir_tabla(out, foto.variables);
+    escribir_tabla(out, foto.funciones);
+    escribir_tabla(out, foto.listas);
+    escribir_tabla(out, foto.parametros);
+    escribir_tabla(out, foto.numeros);
+    out.write(foto.bytes.data(), foto.bytes.size());
+    return (bool)out;
+}
+
+bool foto_grabar(AST* tree, const char* archivo) {
+    std::vector<AST*> sentencias;
+    aplanar(tree, sentencias);
+    size_t punto = punto_de_foto(tree, sentencias);
+
+    // lo impreso en la inicializacion va tambien a la foto
+    std::ostringstream salida;
+    salida_programa = &salida;
+    for (size_t i = 0; i < punto; ++i) eval_ast(sentencias[i]);
+    salida_programa = &std::cout;
+    std::cout << salida.str() << std::flush;
+
+    if (!escribir_foto(archivo, tree, punto, salida.str())) return false;
+    for (size_t i = punto; i < sentencias.size(); ++i) eval_ast(sentencias[i]);
+    return true;
+}
+
+// Vista de la foto sobre el archivo mapeado
+struct VistaFoto {
+    const CabeceraFoto* cabecera;
+    const TextoFoto* textos;
+    const VariableFoto* variables;
+    const FuncionFoto* funciones;
+    const ListaFoto* listas;
+    const uint32_t* parametros;
+    const uint32_t* numeros;
+    const char* bytes;
+};
+
+template <typename T>
+static bool tomar(const char*& p, const char* fin, uint64_t n, const T*& tabla) {
+    if ((uint64_t)(fin - p) / sizeof(T) < n) return false;
+    tabla = (const T*)p;
+    p += n * sizeof(T);
+    return true;
+}
+
+static bool abrir_vista(const char* base, size_t largo, VistaFoto& v) {
+    const char* p = base;
+    const char* fin = base + largo;
+    if (!tomar(p, fin, 1, v.cabecera) || memcmp(v.cabecera->magia, FOTO_MAGIA, sizeof(FOTO_MAGIA)) != 0)
+        return false;
+    const CabeceraFoto& c = *v.cabecera;
+    if (!tomar(p, fin, c.textos, v.textos) || !tomar(p, fin, c.variables, v.variables) ||
+        !tomar(p, fin, c.funciones, v.funciones) || !tomar(p, fin, c.listas, v.listas) ||
+        !tomar(p, fin, c.parametros, v.parametros) || !tomar(p, fin, c.numeros, v.numeros) ||
+        !tomar(p, fin, c.bytes, v.bytes))
+        return false;
+
+    // los indices tienen que caer dentro de las tablas
+    if (c.salida >= c.textos) return false;
+    for (uint32_t i = 0; i < c.textos; ++i)
+        if (v.textos[i].inicio > c.bytes || v.textos[i].largo > c.bytes - v.textos[i].inicio) return false;
+    for (uint32_t i = 0; i < c.listas; ++i)
+        if (v.listas[i].inicio > c.numeros || v.listas[i].largo > c.numeros - v.listas[i].inicio) return false;
+    for (uint32_t i = 0; i < c.parametros; ++i)
+        if (v.parametros[i] >= c.textos) return false;
+    for (uint32_t i = 0; i < c.variables; ++i) {
+        const VariableFoto& x = v.variables[i];
+        if (x.nombre >= c.textos || x.tipo >= c.textos || x.clase > Value::NONE) return false;
+        if ((x.clase == Value::STRING && x.dato >= c.textos) || (x.clase == Value::LIST && x.dato >= c.listas))
+            return false;
+    }
+    for (uint32_t i = 0; i < c.funciones; ++i) {
+        const FuncionFoto& f = v.funciones[i];
+        if (f.nombre >= c.textos || f.primer_parametro > c.parametros ||
+            f.parametros > c.parametros - f.primer_parametro)
+            return false;
+    }
+    return true;
+}
+
+static std::string texto(const VistaFoto& v, uint32_t i) {
+    return std::string(v.bytes + v.textos[i].inicio, v.textos[i].largo);
+}
+
+// Las variables que compartian una lista la vuelven a compartir: cada lista de la
+// foto se crea una vez y se guarda en 'restauradas' por su indice.
+static Value valor(const VistaFoto& v, const VariableFoto& x, std::vector<std::shared_ptr<Lista>>& restauradas) {
+    switch (x.clase) {
+        case Value::INT: { int i; memcpy(&i, &x.dato, sizeof(i)); return Value(i); }
+        case Value::FLOAT: { float f; memcpy(&f, &x.dato, sizeof(f)); return Value(f); }
+        case Value::STRING: return Value(texto(v, x.dato));
+        case Value::LIST: {
+            std::shared_ptr<Lista>& lista = restauradas[x.dato];
+            if (lista) return Value(lista);
+            const ListaFoto& l = v.listas[x.dato];
+            lista = std::make_shared<Lista>();
+            lista->es_float = l.es_float;
+            if (l.es_float) {
+                lista->flotantes.resize(l.largo);
+                memcpy(lista->flotantes.data(), v.numeros + l.inicio, l.largo * sizeof(float));
+            } else {
+                lista->enteros.resize(l.largo);
+                memcpy(lista->enteros.data(), v.numeros + l.inicio, l.largo * sizeof(int));
+            }
+            return Value(lista);
+        }
+        default: return Value();
+    }
+}
+
+static bool restaurar(const VistaFoto& v, AST* tree) {
+    std::vector<AST*> nodos;
+    if (v.cabecera->funciones > 0) numerar_nodos(tree, nodos);
+
+    auto& variables = variables_interprete();
+    auto& funciones = funciones_interprete();
+    variables.clear();
+    funciones.clear();
+    // se grabaron en el orden del map, asi que cada una va al final
+    std::vector<std::shared_ptr<Lista>> restauradas(v.cabecera->listas);
+    for (uint32_t i = 0; i < v.cabecera->variables; ++i) {
+        const VariableFoto& x = v.variables[i];
+        variables.emplace_hint(variables.end(), texto(v, x.nombre),
+                               VarInfo{texto(v, x.tipo), valor(v, x, restauradas)});
+    }
+    for (uint32_t i = 0; i < v.cabecera->funciones; ++i) {
+        const FuncionFoto& f = v.funciones[i];
+        if (f.cuerpo != SIN_CUERPO && f.cuerpo >= nodos.size()) return false;
+        std::vector<std::string> parametros;
+        for (uint32_t k = 0; k < f.parametros; ++k)
+            parametros.push_back(texto(v, v.parametros[f.primer_parametro + k]));
+        funciones.emplace_hint(funciones.end(), texto(v, f.nombre),
+                               std::make_pair(f.cuerpo == SIN_CUERPO ? nullptr : nodos[f.cuerpo], parametros));
+    }
+    return true;
+}
+
+bool foto_usar(AST* tree, const char* archivo) {
+    int fd = open(archivo, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "No se pudo abrir la foto: " << archivo << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        std::cerr << "Error: la foto " << archivo << " esta vacia o no se puede leer\n";
+        return false;
+    }
+    size_t largo = (size_t)st.st_size;
+    void* mapa = mmap(nullptr, largo, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) {
+        std::cerr << "No se pudo mapear la foto: " << archivo << std::endl;
+        return false;
+    }
+
+    std::vector<AST*> sentencias;
+    aplanar(tree, sentencias);
+    VistaFoto vista;
+    if (!abrir_vista((const char*)mapa, largo, vista) || vista.cabecera->sentencias > sentencias.size()) {
+        munmap(mapa, largo);
+        std::cerr << "Error: la foto " << archivo << " esta danada\n";
+        return false;
+    }
+    if (vista.cabecera->huella != huella(tree)) {
+        munmap(mapa, largo);
+        std::cerr << "Aviso: la foto " << archivo << " no corresponde a este programa, se ejecuta completo\n";
+        eval_ast(tree);
+        return true;
+    }
+
+    bool valida = restaurar(vista, tree);
+    size_t punto = vista.cabecera->sentencias;
+    if (valida) {
+        const TextoFoto& salida = vista.textos[vista.cabecera->salida];
+        std::cout.write(vista.bytes + salida.inicio, salida.largo);
+    }
+    munmap(mapa, largo);
+    if (!valida) {
+        std::cerr << "Error: la foto " << archivo << " esta danada\n";
+        return false;
+    }
+    for (size_t i = punto; i < sentencias.size(); ++i) eval_ast(sentencias[i]);
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef FOTO_H
+#define FOTO_H
+
+#include "ast.h"
+
+// Foto del interprete despues de la inicializacion. Con --foto-grabar se
+// ejecutan las sentencias del programa hasta la primera que llega a un
+// foto_la_wa o a un lee_la_wa (tambien dentro de una funcion que llama), y se
+// guardan las variables, la tabla de funciones y lo que se imprimio hasta ahi.
+// Con --foto-usar una ejecucion posterior mapea el archivo en memoria, restaura
+// ese estado y sigue desde ese punto sin repetir la inicializacion.
+// La foto lleva una huella del arbol optimizado: si el programa (o las opciones
+// del optimizador) cambiaron, se avisa y se ejecuta el programa completo.
+
+// Ejecuta el programa como eval_ast y graba la foto al llegar al punto
+bool foto_grabar(AST* tree, const char* archivo);
+// Restaura la foto y ejecuta el resto del programa
+bool foto_usar(AST* tree, const char* archivo);
+
+#endif
@@ -0,0 +1,148 @@
+#include "intrinsecas.h"
+#include "listas.h"
+#include "presupuesto.h"
+#include <algorithm>
+#include <cmath>
+
+static bool es_numero(const Value& v) {
+    return v.type == Value::INT || v.type == Value::FLOAT;
+}
+
+static float como_float(const Value& v) {
+    return (v.type == Value::FLOAT) ? v.asFloat() : v.asInt();
+}
+
+static void exigir_numeros(const char* nombre, const Value* args, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (!es_numero(args[i])) {
+            error_ejecucion(std::string(nombre) + " espera numeros");
+        }
+    }
+}
+
+static const Lista& exigir_lista(const char* nombre, const Value& v) {
+    if (v.type != Value::LIST) {
+        error_ejecucion(std::string(nombre) + " espera una lista");
+    }
+    return *v.asList();
+}
+
+static Value potencia(const Value* args, size_t) {
+    exigir_numeros("potencia", args, 2);
+    if (args[0].type == Value::INT && args[1].type == Value::INT && args[1].asInt() >= 0) {
+        // exponenciacion por cuadrados, con el mismo desborde que la multiplicacion de int
+        unsigned int base = args[0].asInt();
+        unsigned int res = 1;
+        for (int e = args[1].asInt(); e > 0; e >>= 1) {
+            if (e & 1) res *= base;
+            base *= base;
+        }
+        return Value((int)res);
+    }
+    return Value(std::pow(como_float(args[0]), como_float(args[1])));
+}
+
+static Value raiz(const Value* args, size_t) {
+    exigir_numeros("raiz", args, 1);
+    return Value(std::sqrt(como_float(args[0])));
+}
+
+static Value absoluto(const Value* args, size_t) {
+    exigir_numeros("absoluto", args, 1);
+    if (args[0].type == Value::INT) return Value(std::abs(args[0].asInt()));
+    return Value(std::fabs(args[0].asFloat()));
+}
+
+// minimo/maximo de dos numeros, o de una lista
+static Value extremo(const Value* args, size_t n, bool maximo) {
+    const char* nombre = maximo ? "maximo" : "minimo";
+    if (n == 1) return extremo_lista(exigir_lista(nombre, args[0]), maximo);
+
+    exigir_numeros(nombre, args, 2);
+    if (args[0].type == Value::INT && args[1].type == Value::INT) {
+        int a = args[0].asInt(), b = args[1].asInt();
+        return Value(maximo ? std::max(a, b) : std::min(a, b));
+    }
+    float a = como_float(args[0]), b = como_float(args[1]);
+    return Value(maximo ? std::max(a, b) : std::min(a, b));
+}
+
+static Value minimo(const Value* args, size_t n) { return extremo(args, n, false); }
+static Value maximo(const Value* args, size_t n) { return extremo(args, n, true); }
+
+static Value largo(const Value* args, size_t) {
+    if (args[0].type == Value::STRING) return Value((int)std::get<std::string>(args[0].val).size());
+    return Value((int)exigir_lista("largo", args[0]).largo());
+}
+
+static Value subcadena(const Value* args, size_t) {
+    if (args[0].type != Value::STRING || args[1].type != Value::INT || args[2].type != Value::INT) {
+        error_ejecucion("subcadena espera (palabrita, numerito, numerito)");
+    }
+    const std::string& s = std::get<std::string>(args[0].val);
+    int inicio = args[1].asInt();
+    int cantidad = args[2].asInt();
+    if (inicio < 0 || (size_t)inicio > s.size() || cantidad < 0) {
+        error_ejecucion("subcadena fuera de rango");
+    }
+    return Value(s.substr(inicio, cantidad));
+}
+
+static Value texto(const Value* args, size_t) {
+    switch (args[0].type) {
+        case Value::INT: return Value(std::to_string(args[0].asInt()));
+        case Value::FLOAT: return Value(std::to_string(args[0].asFloat()));
+        case Value::STRING: return args[0];
+        case Value::LIST: return Value(lista_a_texto(*args[0].asList()));
+        default: return Value(std::string());
+    }
+}
+
+static Value sumatoria(const Value* args, size_t) {
+    return sumatoria_lista(exigir_lista("sumatoria", args[0]));
+}
+
+static Value producto_punto(const Value* args, size_t) {
+    return producto_punto_listas(exigir_lista("producto_punto", args[0]),
+                                 exigir_lista("producto_punto", args[1]));
+}
+
+static Value rango(const Value* args, size_t) {
+    if (args[0].type != Value::INT || args[0].asInt() < 0) {
+        error_ejecucion("rango espera un numerito no negativo");
+    }
+    return rango_lista(args[0].asInt());
+}
+
+static const Intrinseca tabla_intrinsecas[] = {
+    // con dos enteros, el mismo desborde de 32 bits que el interprete (exponente >= 0)
+    {"potencia", 2, 2, potencia, "_chl_potencia",
+     "template<class A, class B> auto _chl_potencia(A base, B exponente) {\n"
+     "if constexpr (is_integral_v<A> && is_integral_v<B>) {\n"
+     "if (exponente < 0) return (int32_t)pow((float)base, (float)exponente);\n"
+     "uint32_t b = (uint32_t)base, r = 1;\n"
+     "for (; exponente > 0; exponente >>= 1) { if (exponente & 1) r *= b; b *= b; }\n"
+     "return (int32_t)r;\n"
+     "} else {\nreturn pow((float)base, (float)exponente);\n}\n}\n", false},
+    {"raiz", 1, 1, raiz, "_chl_raiz", "float _chl_raiz(float x) { return sqrt(x); }\n", false},
+    {"absoluto", 1, 1, absoluto, "abs", nullptr, false},
+    {"minimo", 1, 2, minimo, "_chl_minimo",
+     "template<class A, class B> auto _chl_minimo(A a, B b) { return a < b ? a : b; }\n", false},
+    {"maximo", 1, 2, maximo, "_chl_maximo",
+     "template<class A, class B> auto _chl_maximo(A a, B b) { return a > b ? a : b; }\n", false},
+    {"largo", 1, 1, largo, "_chl_largo",
+     "int32_t _chl_largo(const string& s) { return (int32_t)s.size(); }\n", false},
+    {"subcadena", 3, 3, subcadena, "_chl_subcadena",
+     "string _chl_subcadena(const string& s, int32_t inicio, int32_t cantidad) { return s.substr(inicio, cantidad); }\n", false},
+    {"texto", 1, 1, texto, "_chl_texto", nullptr, false},
+    {"sumatoria", 1, 1, sumatoria, "_chl_sumatoria", nullptr, true},
+    {"producto_punto", 2, 2, producto_punto, "_chl_producto_punto", nullptr, true},
+    {"rango", 1, 1, rango, "_chl_rango", nullptr, true},
+};
+
+const Intrinseca* buscar_intrinseca(const std::string& nombre) {
+    for (const Intrinseca& in : tabla_intrinsecas) {
+        if (nombre == in.nombre) return &in;
+    }
+    return nullptr;
+}
@@ -0,0 +1,25 @@
+#ifndef INTRINSECAS_H
+#define INTRINSECAS_H
+
+#include <cstddef>
+#include <string>
+#include "ast.h"
+
+// Funcion del lenguaje implementada en C++. El interprete la llama directo
+// y el generador de codigo la traduce a 'nombre_cpp'.
+struct Intrinseca {
+    const char* nombre;
+    size_t min_args;
+    size_t max_args;
+    Value (*funcion)(const Value* args, size_t n);
+    const char* nombre_cpp;
+    const char* definicion_cpp; // ayuda que se agrega al C++ generado, o nullptr
+    bool usa_listas;            // su version en C++ necesita las operaciones de listas
+};
+
+// Maximo de argumentos de cualquier intrinseca
+const size_t MAX_ARGS_INTRINSECA = 3;
+
+const Intrinseca* buscar_intrinseca(const std::string& nombre);
+
+#endif
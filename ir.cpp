@@ -0,0 +1,612 @@
+#include "ir.h"
+#include "intrinsecas.h"
+#include "segun.h"
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+bool usar_ir = false;
+bool dump_ir = false;
+
+// Estado mientras se baja una funcion: el bloque donde se agregan instrucciones
+// y el valor SSA que tiene cada variable en ese punto
+struct Constructor {
+    FuncionIR* f = nullptr;
+    int bloque = 0;
+    std::map<std::string, int> vars;
+    std::map<std::string, std::string> tipos; // tipo declarado, "" para parametros
+    int ciclos = 0;
+    int nulo = -1;
+    std::string motivo;
+};
+
+static std::map<std::string, int> indice_funcion;
+static std::map<std::string, AST*> definiciones;
+
+static int fallar(Constructor& c, const std::string& motivo) {
+    if (c.motivo.empty()) c.motivo = motivo;
+    return -1;
+}
+
+static int nuevo_bloque(Constructor& c) {
+    c.f->bloques.emplace_back();
+    return (int)c.f->bloques.size() - 1;
+}
+
+static void enlazar(Constructor& c, int desde, int hasta) {
+    c.f->bloques[hasta].preds.push_back(desde);
+}
+
+static int emitir(Constructor& c, OpIR op, std::vector<int> args = {}, bool define = true) {
+    InstrIR& instr = c.f->bloques[c.bloque].instrs.emplace_back();
+    instr.op = op;
+    instr.args = std::move(args);
+    if (define) instr.valor = c.f->num_valores++;
+    return instr.valor;
+}
+
+static InstrIR& ultima(Constructor& c) {
+    return c.f->bloques[c.bloque].instrs.back();
+}
+
+static int constante(Constructor& c, const Value& v) {
+    int valor = emitir(c, IR_CONST);
+    ultima(c).constante = v;
+    return valor;
+}
+
+// Valor de las sentencias que no producen nada; vive en la entrada para dominar todo
+static int valor_nulo(Constructor& c) {
+    if (c.nulo < 0) {
+        std::vector<InstrIR>& entrada = c.f->bloques[0].instrs;
+        InstrIR& instr = *entrada.emplace(entrada.begin());
+        instr.op = IR_CONST;
+        instr.valor = c.nulo = c.f->num_valores++;
+    }
+    return c.nulo;
+}
+
+static void saltar(Constructor& c, int destino) {
+    emitir(c, IR_SALTO, {}, false);
+    ultima(c).destinos[0] = destino;
+    enlazar(c, c.bloque, destino);
+}
+
+static bool menciona(AST* tree, const std::string& nombre) {
+    if (!tree) return false;
+    if (tree->type == NODE_ID && nombre == tree->data.id) return true;
+    for (AST** hijo : ast_hijos(tree))
+        if (menciona(*hijo, nombre)) return true;
+    return false;
+}
+
+static bool contiene(AST* tree, NodeType tipo) {
+    if (!tree) return false;
+    if (tree->type == tipo) return true;
+    for (AST** hijo : ast_hijos(tree))
+        if (contiene(*hijo, tipo)) return true;
+    return false;
+}
+
+static int bajar(Constructor& c, AST* tree);
+
+static int bajar_lista(Constructor& c, const std::vector<AST*>& nodos, std::vector<int>& valores) {
+    for (AST* nodo : nodos) {
+        int v = bajar(c, nodo);
+        if (v < 0) return -1;
+        valores.push_back(v);
+    }
+    return 0;
+}
+
+// Valor que llega por cada predecesor: phi si no son todos el mismo
+static int juntar_valor(Constructor& c, const std::vector<int>& valores) {
+    for (int v : valores)
+        if (v != valores[0]) return emitir(c, IR_PHI, valores);
+    return valores[0];
+}
+
+// Junta los valores de las variables que llegan de cada lado de un si_po o de
+// cada caso de un segun
+static void juntar(Constructor& c, const std::map<std::string, int>& antes,
+                   std::vector<std::map<std::string, int>>& lados) {
+    c.vars.clear();
+    for (const auto& [nombre, _] : antes) {
+        std::vector<int> valores;
+        for (std::map<std::string, int>& lado : lados) valores.push_back(lado[nombre]);
+        c.vars[nombre] = juntar_valor(c, valores);
+    }
+}
+
+static int bajar_si(Constructor& c, AST* tree) {
+    int cond = bajar(c, tree->data.ctrl.cond);
+    if (cond < 0) return -1;
+    int nulo = valor_nulo(c);
+    int origen = c.bloque;
+    int b_si = nuevo_bloque(c);
+    int b_no = tree->data.ctrl.else_branch ? nuevo_bloque(c) : -1;
+    int b_fin = nuevo_bloque(c);
+
+    emitir(c, IR_SI, {cond}, false);
+    ultima(c).sitio = tree->sitio;
+    ultima(c).destinos[0] = b_si;
+    ultima(c).destinos[1] = b_no >= 0 ? b_no : b_fin;
+    std::map<std::string, int> antes = c.vars;
+
+    enlazar(c, origen, b_si);
+    c.bloque = b_si;
+    int r_si = bajar(c, tree->data.ctrl.then_branch);
+    if (r_si < 0) return -1;
+    std::map<std::string, int> vars_si = c.vars;
+    saltar(c, b_fin);
+
+    int r_no = nulo;
+    std::map<std::string, int> vars_no = antes;
+    if (b_no >= 0) {
+        c.vars = antes;
+        enlazar(c, origen, b_no);
+        c.bloque = b_no;
+        r_no = bajar(c, tree->data.ctrl.else_branch);
+        if (r_no < 0) return -1;
+        vars_no = c.vars;
+        saltar(c, b_fin);
+    } else {
+        enlazar(c, origen, b_fin);
+    }
+
+    c.bloque = b_fin;
+    std::vector<std::map<std::string, int>> lados = {vars_si, vars_no};
+    juntar(c, antes, lados);
+    return juntar_valor(c, {r_si, r_no});
+}
+
+// segun: un bloque por caso (y por el si_no_po) que salta al final. Sin
+// si_no_po, el valor que no coincide va directo al final.
+static int bajar_segun(Constructor& c, AST* tree) {
+    int clave = bajar(c, tree->data.segun.expr);
+    if (clave < 0) return -1;
+    int nulo = valor_nulo(c);
+    int origen = c.bloque;
+    const std::vector<AST*>& cuerpos = *tree->data.segun.cuerpos;
+    AST* defecto = tree->data.segun.defecto;
+
+    std::vector<int> bloques;
+    for (size_t i = 0; i < cuerpos.size(); ++i) bloques.push_back(nuevo_bloque(c));
+    if (defecto) bloques.push_back(nuevo_bloque(c));
+    int b_fin = nuevo_bloque(c);
+
+    emitir(c, IR_SEGUN, {clave}, false);
+    ultima(c).tabla = tree->data.segun.tabla;
+    ultima(c).casos = bloques;
+    if (!defecto) ultima(c).casos.push_back(b_fin);
+    std::map<std::string, int> antes = c.vars;
+
+    std::vector<std::map<std::string, int>> lados;
+    std::vector<int> resultados;
+    for (size_t i = 0; i < bloques.size(); ++i) {
+        c.vars = antes;
+        enlazar(c, origen, bloques[i]);
+        c.bloque = bloques[i];
+        int r = bajar(c, i < cuerpos.size() ? cuerpos[i] : defecto);
+        if (r < 0) return -1;
+        if (tree->data.segun.valor_del_ultimo && i + 1 != cuerpos.size()) r = nulo;
+        resultados.push_back(r);
+        lados.push_back(c.vars);
+        saltar(c, b_fin);
+    }
+    if (!defecto) {
+        enlazar(c, origen, b_fin);
+        resultados.push_back(nulo);
+        lados.push_back(antes);
+    }
+
+    c.bloque = b_fin;
+    juntar(c, antes, lados);
+    return juntar_valor(c, resultados);
+}
+
+// mientras_la_wa y pa_cada: cabecera con una phi por variable, cuerpo y salida
+static int bajar_ciclo(Constructor& c, AST* cond, AST* cuerpo, AST* paso, int sitio) {
+    int cabecera = nuevo_bloque(c);
+    saltar(c, cabecera);
+    c.bloque = cabecera;
+
+    std::vector<std::pair<std::string, size_t>> phis;
+    for (auto& [nombre, valor] : c.vars) {
+        phis.push_back({nombre, c.f->bloques[cabecera].instrs.size()});
+        valor = emitir(c, IR_PHI, {valor});
+    }
+
+    int v_cond = bajar(c, cond);
+    if (v_cond < 0) return -1;
+    int b_cuerpo = nuevo_bloque(c);
+    int b_fin = nuevo_bloque(c);
+    emitir(c, IR_SI, {v_cond}, false);
+    ultima(c).sitio = sitio;
+    ultima(c).destinos[0] = b_cuerpo;
+    ultima(c).destinos[1] = b_fin;
+    enlazar(c, c.bloque, b_cuerpo);
+    enlazar(c, c.bloque, b_fin);
+    std::map<std::string, int> salida = c.vars;
+
+    c.ciclos++;
+    c.bloque = b_cuerpo;
+    if (bajar(c, cuerpo) < 0 || bajar(c, paso) < 0) return -1;
+    c.ciclos--;
+    saltar(c, cabecera);
+    for (const auto& [nombre, posicion] : phis)
+        c.f->bloques[cabecera].instrs[posicion].args.push_back(c.vars[nombre]);
+
+    c.bloque = b_fin;
+    c.vars = salida;
+    return valor_nulo(c);
+}
+
+static int bajar_llamada(Constructor& c, AST* tree) {
+    std::vector<AST*> args;
+    if (tree->data.func_call.args && tree->data.func_call.args->data.args.values)
+        args = *(tree->data.func_call.args->data.args.values);
+
+    // el interprete restaura las variables despues de la llamada, incluso lo
+    // que asignen los argumentos
+    for (AST* arg : args) {
+        if (contiene(arg, NODE_ASSIGN) || contiene(arg, NODE_INPUT) || contiene(arg, NODE_INDEX_ASSIGN))
+            return fallar(c, "asignacion dentro de un argumento de llamada");
+    }
+
+    std::vector<int> valores;
+    if (tree->data.func_call.intrinseca) {
+        if (bajar_lista(c, args, valores) < 0) return -1;
+        int v = emitir(c, IR_INTRINSECA, valores);
+        ultima(c).intrinseca = tree->data.func_call.intrinseca;
+        return v;
+    }
+
+    std::string nombre = tree->data.func_call.name;
+    if (!indice_funcion.count(nombre))
+        return fallar(c, "llamada a '" + nombre + "', que no es una funcion de primer nivel");
+    AST* def = definiciones[nombre];
+    std::vector<std::string> params;
+    if (def->data.func_def.params && def->data.func_def.params->data.params.names)
+        params = *(def->data.func_def.params->data.params.names);
+
+    // los argumentos se evaluan con los parametros anteriores ya asignados
+    for (size_t i = 0; i < args.size() && i < params.size(); ++i) {
+        for (size_t j = 0; j < i; ++j)
+            if (menciona(args[i], params[j]))
+                return fallar(c, "un argumento de '" + nombre + "' usa el parametro '" + params[j] + "'");
+    }
+
+    // los argumentos que sobran no se evaluan; los que faltan quedan nulos
+    for (size_t i = 0; i < params.size(); ++i) {
+        int v = i < args.size() ? bajar(c, args[i]) : valor_nulo(c);
+        if (v < 0) return -1;
+        valores.push_back(v);
+    }
+    int v = emitir(c, IR_LLAMADA, valores);
+    ultima(c).entero = indice_funcion[nombre];
+    ultima(c).sitio = tree->sitio;
+    return v;
+}
+
+static int bajar(Constructor& c, AST* tree) {
+    if (!tree) return valor_nulo(c);
+
+    switch (tree->type) {
+        case NODE_INT: return constante(c, Value(tree->data.intval));
+        case NODE_FLOAT: return constante(c, Value(tree->data.floatval));
+        case NODE_STRING: return constante(c, Value(std::string(tree->data.strval)));
+        case NODE_ID: {
+            auto it = c.vars.find(tree->data.id);
+            if (it == c.vars.end())
+                return fallar(c, "'" + c.f->nombre + "' usa la variable '" + std::string(tree->data.id) +
+                                 "', declarada fuera de ella o dentro de un bloque");
+            return it->second;
+        }
+        case NODE_DECL: {
+            if (c.ciclos > 0)
+                return fallar(c, "declaracion de '" + std::string(tree->data.decl.nombre) + "' dentro de un ciclo");
+            c.vars[tree->data.decl.nombre] = valor_nulo(c);
+            c.tipos[tree->data.decl.nombre] = tree->data.decl.tipo;
+            return valor_nulo(c);
+        }
+        case NODE_ASSIGN:
+        case NODE_INPUT: {
+            AST* var_node = tree->type == NODE_ASSIGN ? tree->data.bin.left : tree->data.input.variable;
+            std::string var = var_node->data.id;
+            if (!c.vars.count(var))
+                return fallar(c, "asignacion a '" + var + "', declarada fuera de la funcion o del bloque");
+            if (c.tipos[var].empty())
+                return fallar(c, "asignacion al parametro '" + var + "'");
+            int v;
+            if (tree->type == NODE_ASSIGN) {
+                int val = bajar(c, tree->data.bin.right);
+                if (val < 0) return -1;
+                v = emitir(c, IR_ASIGNA, {val});
+            } else {
+                v = emitir(c, IR_LEE);
+            }
+            ultima(c).texto = c.tipos[var];
+            ultima(c).variable = var;
+            c.vars[var] = v;
+            return v;
+        }
+        case NODE_PRINT: {
+            AST* expr = tree->data.bin.left;
+            std::vector<int> valores;
+            if (expr && expr->type == NODE_CONCAT) {
+                if (bajar_lista(c, *expr->data.concat.partes, valores) < 0) return -1;
+                emitir(c, IR_IMPRIME_PARTES, valores, false);
+            } else {
+                int v = bajar(c, expr);
+                if (v < 0) return -1;
+                emitir(c, IR_IMPRIME, {v}, false);
+            }
+            return valor_nulo(c);
+        }
+        case NODE_BINOP: {
+            int l = bajar(c, tree->data.bin.left);
+            if (l < 0) return -1;
+            int r = bajar(c, tree->data.bin.right);
+            if (r < 0) return -1;
+            int v = emitir(c, IR_BINOP, {l, r});
+            ultima(c).entero = tree->op;
+            return v;
+        }
+        case NODE_CONCAT:
+        case NODE_LIST: {
+            std::vector<int> valores;
+            const std::vector<AST*>& nodos = tree->type == NODE_CONCAT ? *tree->data.concat.partes
+                                                                       : *tree->data.lista.elementos;
+            if (bajar_lista(c, nodos, valores) < 0) return -1;
+            return emitir(c, tree->type == NODE_CONCAT ? IR_CONCAT : IR_LISTA, valores);
+        }
+        case NODE_INDEX: {
+            int lista = bajar(c, tree->data.index.lista);
+            if (lista < 0) return -1;
+            int indice = bajar(c, tree->data.index.indice);
+            if (indice < 0) return -1;
+            return emitir(c, IR_INDICE, {lista, indice});
+        }
+        case NODE_INDEX_ASSIGN:
+            return fallar(c, "asignacion a un elemento de lista");
+        case NODE_SEQ: {
+            if (bajar(c, tree->data.seq.first) < 0) return -1;
+            return bajar(c, tree->data.seq.second);
+        }
+        case NODE_IF:
+            return bajar_si(c, tree);
+        case NODE_SWITCH:
+            return bajar_segun(c, tree);
+        case NODE_WHILE:
+            return bajar_ciclo(c, tree->data.ctrl.cond, tree->data.ctrl.then_branch, nullptr, tree->sitio);
+        case NODE_FOR: {
+            if (bajar(c, tree->data.for_loop.init) < 0) return -1;
+            return bajar_ciclo(c, tree->data.for_loop.cond, tree->data.for_loop.body, tree->data.for_loop.update, tree->sitio);
+        }
+        case NODE_FUNC_CALL:
+            return bajar_llamada(c, tree);
+        case NODE_RETURN:
+            return bajar(c, tree->data.ret.expr);
+        case NODE_FOTO:
+            return valor_nulo(c);
+        case NODE_FUNC_DEF:
+            return fallar(c, "funcion '" + std::string(tree->data.func_def.name) + "' definida dentro de un bloque");
+        default:
+            return fallar(c, "nodo no soportado por la IR");
+    }
+}
+
+static void aplanar(AST* tree, std::vector<AST*>& sentencias) {
+    if (!tree) return;
+    if (tree->type == NODE_SEQ) {
+        aplanar(tree->data.seq.first, sentencias);
+        aplanar(tree->data.seq.second, sentencias);
+    } else {
+        sentencias.push_back(tree);
+    }
+}
+
+static void llamadas_de(AST* tree, std::set<std::string>& llamadas) {
+    if (!tree || tree->type == NODE_FUNC_DEF) return;
+    if (tree->type == NODE_FUNC_CALL && !tree->data.func_call.intrinseca)
+        llamadas.insert(tree->data.func_call.name);
+    for (AST** hijo : ast_hijos(tree))
+        llamadas_de(*hijo, llamadas);
+}
+
+static void alcanzables(const std::string& nombre, std::set<std::string>& vistas) {
+    if (vistas.count(nombre) || !definiciones.count(nombre)) return;
+    vistas.insert(nombre);
+    std::set<std::string> llamadas;
+    llamadas_de(definiciones[nombre]->data.func_def.body, llamadas);
+    for (const std::string& llamada : llamadas)
+        alcanzables(llamada, vistas);
+}
+
+// El interprete registra cada funcion al pasar por su definicion: toda funcion
+// que se pueda alcanzar desde una sentencia ya tiene que estar definida
+static bool revisar_definiciones(const std::vector<AST*>& sentencias, std::string& motivo) {
+    std::set<std::string> definidas;
+    for (AST* s : sentencias) {
+        if (s->type == NODE_FUNC_DEF) {
+            if (!definidas.insert(s->data.func_def.name).second) {
+                motivo = "la funcion '" + std::string(s->data.func_def.name) + "' se define dos veces";
+                return false;
+            }
+            continue;
+        }
+        std::set<std::string> llamadas, vistas;
+        llamadas_de(s, llamadas);
+        for (const std::string& nombre : llamadas)
+            alcanzables(nombre, vistas);
+        for (const std::string& nombre : llamadas)
+            if (!definiciones.count(nombre)) vistas.insert(nombre);
+        for (const std::string& nombre : vistas) {
+            if (!definidas.count(nombre)) {
+                motivo = "se llama a '" + nombre + "' antes de definirla";
+                return false;
+            }
+        }
+    }
+
+    // una funcion recursiva que declara variables choca con la declaracion de
+    // la llamada anterior, que sigue visible
+    for (const auto& [nombre, def] : definiciones) {
+        std::set<std::string> llamadas, vistas;
+        llamadas_de(def->data.func_def.body, llamadas);
+        for (const std::string& llamada : llamadas)
+            alcanzables(llamada, vistas);
+        if (vistas.count(nombre) && contiene(def->data.func_def.body, NODE_DECL)) {
+            motivo = "la funcion recursiva '" + nombre + "' declara variables";
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool bajar_funcion(FuncionIR& f, AST* cuerpo, const std::vector<AST*>* sentencias, std::string& motivo) {
+    Constructor c;
+    c.f = &f;
+    c.bloque = 0;
+    f.bloques.emplace_back();
+
+    for (size_t i = 0; i < f.params.size(); ++i) {
+        int v = emitir(c, IR_PARAM);
+        ultima(c).entero = (int)i;
+        ultima(c).variable = f.params[i];
+        c.vars[f.params[i]] = v;
+        c.tipos[f.params[i]] = "";
+    }
+
+    int resultado = valor_nulo(c);
+    if (sentencias) {
+        for (AST* s : *sentencias) {
+            if (s->type == NODE_FUNC_DEF) continue;
+            if (bajar(c, s) < 0) break;
+        }
+    } else {
+        resultado = bajar(c, cuerpo);
+    }
+    if (!c.motivo.empty()) {
+        motivo = c.motivo;
+        return false;
+    }
+    emitir(c, IR_DEVUELVE, {resultado}, false);
+    return true;
+}
+
+bool construir_ir(AST* tree, ProgramaIR& programa, std::string& motivo) {
+    std::vector<AST*> sentencias;
+    aplanar(tree, sentencias);
+
+    indice_funcion.clear();
+    definiciones.clear();
+    programa.funciones.clear();
+    programa.funciones.emplace_back();
+    programa.funciones[0].nombre = "principal";
+    for (AST* s : sentencias) {
+        if (s->type != NODE_FUNC_DEF) continue;
+        std::string nombre = s->data.func_def.name;
+        if (!definiciones.count(nombre)) {
+            indice_funcion[nombre] = (int)programa.funciones.size();
+            programa.funciones.emplace_back();
+            programa.funciones.back().nombre = nombre;
+            if (s->data.func_def.params && s->data.func_def.params->data.params.names)
+                programa.funciones.back().params = *(s->data.func_def.params->data.params.names);
+        }
+        definiciones[nombre] = s;
+    }
+    if (!revisar_definiciones(sentencias, motivo)) return false;
+
+    if (!bajar_funcion(programa.funciones[0], nullptr, &sentencias, motivo)) return false;
+    for (const auto& [nombre, indice] : indice_funcion) {
+        if (!bajar_funcion(programa.funciones[indice], definiciones[nombre]->data.func_def.body, nullptr, motivo))
+            return false;
+    }
+    return true;
+}
+
+static void imprimir_constante(const Value& v, std::ostream& out) {
+    switch (v.type) {
+        case Value::INT: out << v.asInt(); break;
+        case Value::FLOAT: out << v.asFloat() << "f"; break;
+        case Value::STRING: out << "\"" << v.asString() << "\""; break;
+        default: out << "nulo";
+    }
+}
+
+static void imprimir_args(const std::vector<int>& args, std::ostream& out) {
+    for (size_t i = 0; i < args.size(); ++i)
+        out << (i ? ", " : "") << "v" << args[i];
+}
+
+static void imprimir_instr(const ProgramaIR& programa, const BloqueIR& bloque, const InstrIR& instr,
+                           std::ostream& out) {
+    out << "    ";
+    if (instr.valor >= 0) out << "v" << instr.valor << " = ";
+    switch (instr.op) {
+        case IR_CONST: out << "const "; imprimir_constante(instr.constante, out); break;
+        case IR_PARAM: out << "param " << instr.entero << " (" << instr.variable << ")"; break;
+        case IR_PHI:
+            out << "phi ";
+            for (size_t i = 0; i < instr.args.size(); ++i)
+                out << (i ? ", " : "") << "[v" << instr.args[i] << ", b" << bloque.preds[i] << "]";
+            break;
+        case IR_COPIA: out << "copia v" << instr.args[0]; break;
+        case IR_BINOP:
+            out << "v" << instr.args[0] << " " << op_to_str(instr.entero) << " v" << instr.args[1];
+            break;
+        case IR_CONCAT: out << "concat "; imprimir_args(instr.args, out); break;
+        case IR_LISTA: out << "lista ["; imprimir_args(instr.args, out); out << "]"; break;
+        case IR_INDICE: out << "v" << instr.args[0] << "[v" << instr.args[1] << "]"; break;
+        case IR_ASIGNA: out << "asigna " << instr.texto << " v" << instr.args[0] << " ; " << instr.variable; break;
+        case IR_INTRINSECA:
+            out << instr.intrinseca->nombre << "(";
+            imprimir_args(instr.args, out);
+            out << ")";
+            break;
+        case IR_LLAMADA:
+            out << "llama " << programa.funciones[instr.entero].nombre << "(";
+            imprimir_args(instr.args, out);
+            out << ")";
+            break;
+        case IR_IMPRIME: out << "imprime v" << instr.args[0]; break;
+        case IR_IMPRIME_PARTES: out << "imprime_partes "; imprimir_args(instr.args, out); break;
+        case IR_LEE: out << "lee " << instr.texto << " ; " << instr.variable; break;
+        case IR_SALTO: out << "salta b" << instr.destinos[0]; break;
+        case IR_SI: out << "si v" << instr.args[0] << " b" << instr.destinos[0] << " b" << instr.destinos[1]; break;
+        case IR_SEGUN: {
+            const TablaSegun& tabla = *instr.tabla;
+            out << "segun v" << instr.args[0] << (tabla.densa.empty() ? "" : " (tabla directa)");
+            for (const auto& [clave, caso] : tabla.enteros) out << " " << clave << ":b" << instr.casos[caso];
+            for (const auto& [clave, caso] : tabla.textos) out << " \"" << clave << "\":b" << instr.casos[caso];
+            out << " si_no:b" << instr.casos.back();
+            break;
+        }
+        case IR_DEVUELVE: out << "devuelve v" << instr.args[0]; break;
+    }
+    out << "\n";
+}
+
+void imprimir_ir(const ProgramaIR& programa, std::ostream& out) {
+    for (const FuncionIR& f : programa.funciones) {
+        out << "funcion " << f.nombre << "(";
+        for (size_t i = 0; i < f.params.size(); ++i)
+            out << (i ? ", " : "") << f.params[i];
+        out << "):\n";
+        for (size_t b = 0; b < f.bloques.size(); ++b) {
+            const BloqueIR& bloque = f.bloques[b];
+            out << "  b" << b << ":";
+            if (!bloque.preds.empty()) {
+                out << " ; preds";
+                for (int p : bloque.preds) out << " b" << p;
+            }
+            out << "\n";
+            for (const InstrIR& instr : bloque.instrs)
+                imprimir_instr(programa, bloque, instr, out);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef IR_H
+#define IR_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ast.h"
+
+// Representacion intermedia en forma SSA (--ir). Cada funcion es un grafo de
+// bloques basicos; cada valor se define una sola vez y los valores que llegan
+// por distintos caminos se juntan con phi. Las variables del programa
+// desaparecen: solo quedan valores, asi los pases pueden razonar sin mirar
+// la tabla de variables del interprete.
+
+enum OpIR {
+    IR_CONST,          // v = constante
+    IR_PARAM,          // v = parametro numero 'entero'
+    IR_PHI,            // v = phi(args), un argumento por predecesor del bloque
+    IR_COPIA,          // v = args[0]
+    IR_BINOP,          // v = args[0] <op 'entero'> args[1]
+    IR_CONCAT,         // v = texto de todos los args juntos
+    IR_LISTA,          // v = [args...]
+    IR_INDICE,         // v = args[0][args[1]]
+    IR_ASIGNA,         // v = args[0] revisado/convertido al tipo 'texto' de la variable 'variable'
+    IR_INTRINSECA,     // v = intrinseca(args)
+    IR_LLAMADA,        // v = funcion del usuario numero 'entero'(args)
+    IR_IMPRIME,        // suelta_la_wa args[0]
+    IR_IMPRIME_PARTES, // suelta_la_wa de una concatenacion, sin armar el string
+    IR_LEE,            // v = lee_la_wa de tipo 'texto' para la variable 'variable'
+    IR_SALTO,          // goto destinos[0]
+    IR_SI,             // si args[0] goto destinos[0] si no destinos[1]
+    IR_SEGUN,          // goto casos[tabla->buscar(args[0])]; el ultimo de casos es el por defecto
+    IR_DEVUELVE        // return args[0]
+};
+
+struct InstrIR {
+    OpIR op;
+    int valor = -1; // valor definido, -1 si la instruccion no define ninguno
+    std::vector<int> args;
+    int entero = 0;
+    Value constante;
+    std::string texto;
+    std::string variable;
+    const Intrinseca* intrinseca = nullptr;
+    int destinos[2] = {-1, -1};
+    std::vector<int> casos;
+    const TablaSegun* tabla = nullptr;
+    int sitio = -1; // si_po, ciclo o llamada del arbol, para el perfil de --pgo
+};
+
+struct BloqueIR {
+    std::vector<int> preds;
+    std::vector<InstrIR> instrs; // primero las phi, al final el salto o devuelve
+};
+
+struct FuncionIR {
+    std::string nombre;
+    std::vector<std::string> params;
+    std::vector<BloqueIR> bloques; // bloques[0] es la entrada
+    int num_valores = 0;
+};
+
+struct ProgramaIR {
+    std::vector<FuncionIR> funciones; // funciones[0] es el programa principal
+};
+
+// Tipo que se conoce de un valor sin ejecutar. TIR_NUMERO: resultado de una
+// operacion entre ints, que es int salvo que se desborde (ahi el interprete da
+// float). TIR_DINAMICO: depende de la ejecucion (por ejemplo int / int).
+enum TipoIR {
+    TIR_INDEF, TIR_INT, TIR_NUMERO, TIR_FLOAT, TIR_STRING, TIR_LISTA_INT, TIR_LISTA_FLOAT, TIR_NULO, TIR_DINAMICO
+};
+
+// valores[f][v]: tipo del valor v de la funcion f. Los parametros toman el tipo
+// de los argumentos de todas las llamadas.
+struct TiposIR {
+    std::vector<std::vector<TipoIR>> valores;
+    std::vector<std::vector<TipoIR>> params;
+    std::vector<TipoIR> retornos;
+};
+
+TiposIR inferir_tipos_ir(const ProgramaIR& programa);
+
+// Opciones de linea de comandos
+extern bool usar_ir;
+extern bool dump_ir;
+
+// Baja el arbol a IR. Devuelve false (con el motivo) si el programa usa algo
+// que la IR no representa igual que el interprete; en ese caso se usa el arbol.
+bool construir_ir(AST* tree, ProgramaIR& programa, std::string& motivo);
+
+// Pases: propagacion de copias, GVN/CSE y eliminacion de codigo muerto.
+// Con dump_ir se imprime la IR antes y despues de cada pase.
+void optimizar_ir(ProgramaIR& programa);
+
+void imprimir_ir(const ProgramaIR& programa, std::ostream& out);
+void ejecutar_ir(const ProgramaIR& programa);
+
+// Genera C++ desde la IR. Devuelve false si algun valor no tiene un tipo fijo
+// (el generador del arbol se usa en ese caso).
+bool generar_programa_ir(const ProgramaIR& programa, std::string& codigo, std::string& motivo);
+
+#endif
@@ -0,0 +1,366 @@
+#include "ir.h"
+#include "segun.h"
+#include <charconv>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Generador de C++ desde la IR: cada valor SSA es una variable local con el
+// tipo inferido, cada bloque una etiqueta y las phi se vuelven copias al final
+// de los bloques predecesores.
+
+struct Emisor {
+    const ProgramaIR* programa;
+    const TiposIR* tipos;
+    bool usa_entrada = false;
+    std::set<int> saltos; // bloques de la funcion actual a los que llega algun goto
+    std::string motivo;
+};
+
+static const char* nombre_tipo(TipoIR t) {
+    switch (t) {
+        case TIR_INT:
+        case TIR_NUMERO: return "int32_t";
+        case TIR_FLOAT: return "float";
+        case TIR_STRING: return "string";
+        default: return nullptr;
+    }
+}
+
+static bool es_escalar(TipoIR t) { return nombre_tipo(t) != nullptr; }
+static bool es_entero(TipoIR t) { return t == TIR_INT || t == TIR_NUMERO; }
+
+static bool fallar(Emisor& e, const std::string& motivo) {
+    if (e.motivo.empty()) e.motivo = motivo;
+    return false;
+}
+
+static std::string literal(const Value& v) {
+    switch (v.type) {
+        case Value::INT: return std::to_string(v.asInt());
+        case Value::FLOAT: {
+            char buf[64];
+            auto res = std::to_chars(buf, buf + sizeof(buf), v.asFloat());
+            std::string s(buf, res.ptr);
+            if (s.find_first_of(".e") == std::string::npos) s += ".0";
+            return s + "f";
+        }
+        case Value::STRING: {
+            std::string s = "string(\"";
+            for (char c : v.asString()) {
+                if (c == '"' || c == '\\') s += '\\';
+                if (c == '\n') { s += "\\n"; continue; }
+                s += c;
+            }
+            return s + "\")";
+        }
+        default: return "0";
+    }
+}
+
+static std::string valor(int v) { return "v" + std::to_string(v); }
+
+// Texto de un valor dentro de una concatenacion (mismo formato que el interprete)
+static std::string como_texto(TipoIR t, int v) {
+    return t == TIR_STRING ? valor(v) : "to_string(" + valor(v) + ")";
+}
+
+static std::string condicion(TipoIR t, int v) {
+    if (t == TIR_INT || t == TIR_NUMERO) return valor(v) + " != 0";
+    if (t == TIR_FLOAT) return valor(v) + " != 0.0";
+    return "false";
+}
+
+static bool generar_binop(const InstrIR& instr, const std::vector<TipoIR>& t, std::ostream& out) {
+    int a = instr.args[0], b = instr.args[1];
+    TipoIR l = t[a], r = t[b];
+    std::string dst = "    " + valor(instr.valor) + " = ";
+    switch (instr.entero) {
+        case OP_EQ:
+        case OP_NEQ: {
+            // valores de distinto tipo nunca son iguales
+            bool mismo_tipo = l == r || (es_entero(l) && es_entero(r));
+            std::string igual = mismo_tipo ? valor(a) + " == " + valor(b) : "false";
+            out << dst << (instr.entero == OP_EQ ? "" : "!") << "(" << igual << ") ? 1 : 0;\n";
+            return true;
+        }
+        case OP_PLUS:
+            if (l == TIR_STRING || r == TIR_STRING) {
+                out << dst << como_texto(l, a) << " + " << como_texto(r, b) << ";\n";
+                return true;
+            }
+            [[fallthrough]];
+        case OP_MINUS:
+        case OP_MULT:
+            if (es_entero(l) && es_entero(r)) {
+                // como el interprete: dos int se operan en float
+                out << dst << "(int32_t)((float)" << valor(a) << " " << op_to_str(instr.entero) << " (float)" << valor(b)
+                    << ");\n";
+                return true;
+            }
+            out << dst << valor(a) << " " << op_to_str(instr.entero) << " " << valor(b) << ";\n";
+            return true;
+        case OP_DIV:
+            out << dst << "(" << valor(b) << " != 0) ? (float)" << valor(a) << " / " << valor(b) << " : 0.0f;\n";
+            return true;
+        default:
+            if (es_entero(l) && es_entero(r)) {
+                out << dst << "((float)" << valor(a) << " " << op_to_str(instr.entero) << " (float)" << valor(b)
+                    << ") ? 1 : 0;\n";
+                return true;
+            }
+            out << dst << "(" << valor(a) << " " << op_to_str(instr.entero) << " " << valor(b) << ") ? 1 : 0;\n";
+            return true;
+    }
+}
+
+// Copias de las phi del bloque 'destino' al llegar desde 'desde'
+static void copias_phi(const FuncionIR& f, const std::vector<TipoIR>& t, int desde, int destino,
+                       const std::string& sangria, std::ostream& out) {
+    const BloqueIR& bloque = f.bloques[destino];
+    size_t k = 0;
+    while (k < bloque.preds.size() && bloque.preds[k] != desde) ++k;
+    std::vector<const InstrIR*> phis;
+    for (const InstrIR& instr : bloque.instrs)
+        if (instr.op == IR_PHI) phis.push_back(&instr);
+
+    if (phis.size() == 1) {
+        out << sangria << valor(phis[0]->valor) << " = " << valor(phis[0]->args[k]) << ";\n";
+    } else if (phis.size() > 1) {
+        // todas a la vez: una phi puede leer otra del mismo bloque
+        out << sangria << "{\n";
+        for (size_t i = 0; i < phis.size(); ++i)
+            out << sangria << "    " << nombre_tipo(t[phis[i]->valor]) << " t" << i << " = "
+                << valor(phis[i]->args[k]) << ";\n";
+        for (size_t i = 0; i < phis.size(); ++i)
+            out << sangria << "    " << valor(phis[i]->valor) << " = t" << i << ";\n";
+        out << sangria << "}\n";
+    }
+}
+
+static bool generar_instr(Emisor& e, size_t fi, int b, const InstrIR& instr, std::ostream& out) {
+    const FuncionIR& f = e.programa->funciones[fi];
+    const std::vector<TipoIR>& t = e.tipos->valores[fi];
+    std::string dst = instr.valor >= 0 ? "    " + valor(instr.valor) + " = " : "";
+
+    switch (instr.op) {
+        case IR_CONST:
+            if (t[instr.valor] != TIR_NULO) out << dst << literal(instr.constante) << ";\n";
+            return true;
+        case IR_PARAM:
+        case IR_PHI:
+            return true;
+        case IR_COPIA:
+            out << dst << valor(instr.args[0]) << ";\n";
+            return true;
+        case IR_BINOP:
+            return generar_binop(instr, t, out);
+        case IR_CONCAT: {
+            out << dst << "string()";
+            for (int a : instr.args) out << " + " << como_texto(t[a], a);
+            out << ";\n";
+            return true;
+        }
+        case IR_ASIGNA:
+            // en C++ un int desbordado no pasa a float: se asigna igual
+            if (instr.texto == "int" && t[instr.args[0]] == TIR_NUMERO) {
+                out << dst << valor(instr.args[0]) << ";\n";
+                return true;
+            }
+            if (instr.texto == "float" && es_entero(t[instr.args[0]])) {
+                out << dst << "(float)" << valor(instr.args[0]) << ";\n";
+                return true;
+            }
+            return fallar(e, "asignacion a '" + instr.variable + "' sin tipo fijo");
+        case IR_LLAMADA: {
+            const FuncionIR& llamada = e.programa->funciones[instr.entero];
+            out << (t[instr.valor] == TIR_NULO ? "    " : dst) << llamada.nombre << "(";
+            for (size_t i = 0; i < instr.args.size(); ++i)
+                out << (i ? ", " : "") << valor(instr.args[i]);
+            out << ");\n";
+            return true;
+        }
+        case IR_IMPRIME: {
+            int a = instr.args[0];
+            out << "    cout << " << valor(a) << " << '\\n';\n";
+            return true;
+        }
+        case IR_IMPRIME_PARTES: {
+            out << "    cout";
+            for (int a : instr.args) out << " << " << como_texto(t[a], a);
+            out << " << '\\n';\n";
+            return true;
+        }
+        case IR_LEE:
+            out << dst << "_chl_leer_" << instr.texto << "();\n";
+            return true;
+        case IR_SALTO:
+            e.saltos.insert(instr.destinos[0]);
+            copias_phi(f, t, b, instr.destinos[0], "    ", out);
+            out << "    goto b" << instr.destinos[0] << ";\n";
+            return true;
+        case IR_SI: {
+            std::string marca_si, marca_no;
+            marcas_probabilidad(instr.sitio, marca_si, marca_no);
+            e.saltos.insert(instr.destinos[0]);
+            e.saltos.insert(instr.destinos[1]);
+            out << "    if (" << condicion(t[instr.args[0]], instr.args[0]) << ")" << marca_si << " {\n";
+            copias_phi(f, t, b, instr.destinos[0], "        ", out);
+            out << "        goto b" << instr.destinos[0] << ";\n    } else" << marca_no << " {\n";
+            copias_phi(f, t, b, instr.destinos[1], "        ", out);
+            out << "        goto b" << instr.destinos[1] << ";\n    }\n";
+            return true;
+        }
+        case IR_SEGUN: {
+            // clave int: switch; texto: cadena de if; otro tipo: nunca coincide
+            int a = instr.args[0];
+            const TablaSegun& tabla = *instr.tabla;
+            auto ir_a = [&](int destino, const std::string& sangria) {
+                e.saltos.insert(destino);
+                copias_phi(f, t, b, destino, sangria, out);
+                out << sangria << "goto b" << destino << ";\n";
+            };
+            if (es_entero(t[a])) {
+                out << "    switch (" << valor(a) << ") {\n";
+                for (const auto& [clave, caso] : tabla.enteros) {
+                    out << "    case " << clave << ": {\n";
+                    ir_a(instr.casos[caso], "        ");
+                    out << "    }\n";
+                }
+                out << "    default: {\n";
+                ir_a(instr.casos.back(), "        ");
+                out << "    }\n    }\n";
+            } else if (t[a] == TIR_STRING && !tabla.textos.empty()) {
+                for (size_t i = 0; i < tabla.textos.size(); ++i) {
+                    out << (i ? " else if (" : "    if (") << valor(a) << " == "
+                        << literal(Value(tabla.textos[i].first)) << ") {\n";
+                    ir_a(instr.casos[tabla.textos[i].second], "        ");
+                    out << "    }";
+                }
+                out << " else {\n";
+                ir_a(instr.casos.back(), "        ");
+                out << "    }\n";
+            } else {
+                out << "    (void)" << valor(a) << ";\n";
+                ir_a(instr.casos.back(), "    ");
+            }
+            return true;
+        }
+        case IR_DEVUELVE:
+            if (fi == 0) out << "    return 0;\n";
+            else if (e.tipos->retornos[fi] == TIR_NULO) out << "    return;\n";
+            else out << "    return " << valor(instr.args[0]) << ";\n";
+            return true;
+        default:
+            return fallar(e, "la IR de '" + f.nombre + "' usa listas o funciones incluidas");
+    }
+}
+
+// Todos los valores que llegan a C++ tienen que tener un tipo escalar fijo;
+// los nulos solo pueden ser el resultado de una funcion sin valor
+static bool revisar_tipos(Emisor& e, size_t fi) {
+    const FuncionIR& f = e.programa->funciones[fi];
+    const std::vector<TipoIR>& t = e.tipos->valores[fi];
+    for (const BloqueIR& bloque : f.bloques) {
+        for (const InstrIR& instr : bloque.instrs) {
+            if (instr.valor >= 0 && !es_escalar(t[instr.valor]) && t[instr.valor] != TIR_NULO)
+                return fallar(e, "v" + std::to_string(instr.valor) + " de '" + f.nombre + "' no tiene un tipo fijo");
+            for (int a : instr.args) {
+                if (t[a] == TIR_NULO && instr.op != IR_DEVUELVE)
+                    return fallar(e, "'" + f.nombre + "' usa un valor nulo");
+            }
+        }
+    }
+    if (fi == 0) return true;
+    for (TipoIR p : e.tipos->params[fi])
+        if (!es_escalar(p)) return fallar(e, "un parametro de '" + f.nombre + "' no tiene un tipo fijo");
+    TipoIR r = e.tipos->retornos[fi];
+    if (!es_escalar(r) && r != TIR_NULO)
+        return fallar(e, "el resultado de '" + f.nombre + "' no tiene un tipo fijo");
+    return true;
+}
+
+static std::string firma(const Emisor& e, size_t fi) {
+    const FuncionIR& f = e.programa->funciones[fi];
+    TipoIR r = e.tipos->retornos[fi];
+    std::string s = std::string(r == TIR_NULO ? "void" : nombre_tipo(r)) + " " + f.nombre + "(";
+    for (size_t i = 0; i < f.params.size(); ++i)
+        s += std::string(i ? ", " : "") + nombre_tipo(e.tipos->params[fi][i]) + " p" + std::to_string(i);
+    return s + ")";
+}
+
+static bool generar_funcion(Emisor& e, size_t fi, std::ostream& out) {
+    const FuncionIR& f = e.programa->funciones[fi];
+    const std::vector<TipoIR>& t = e.tipos->valores[fi];
+    out << (fi == 0 ? "int main()" : firma(e, fi)) << " {\n";
+    if (fi == 0) out << inicio_main(e.usa_entrada, "    ");
+
+    for (const BloqueIR& bloque : f.bloques) {
+        for (const InstrIR& instr : bloque.instrs) {
+            if (instr.valor < 0 || t[instr.valor] == TIR_NULO) continue;
+            out << "    " << nombre_tipo(t[instr.valor]) << " " << valor(instr.valor);
+            if (instr.op == IR_PARAM) out << " = p" << instr.entero;
+            out << ";\n";
+        }
+    }
+
+    // las etiquetas van despues, solo donde llega un goto: un caso de un segun
+    // que no puede coincidir queda sin salto
+    e.saltos.clear();
+    std::vector<std::string> bloques;
+    for (size_t b = 0; b < f.bloques.size(); ++b) {
+        std::ostringstream codigo;
+        for (const InstrIR& instr : f.bloques[b].instrs)
+            if (!generar_instr(e, fi, (int)b, instr, codigo)) return false;
+        bloques.push_back(codigo.str());
+    }
+    for (size_t b = 0; b < f.bloques.size(); ++b) {
+        if (b > 0 && e.saltos.count((int)b)) out << "b" << b << ":;\n";
+        out << bloques[b];
+    }
+    out << "}\n\n";
+    return true;
+}
+
+bool generar_programa_ir(const ProgramaIR& programa, std::string& codigo, std::string& motivo) {
+    TiposIR tipos = inferir_tipos_ir(programa);
+    Emisor e;
+    e.programa = &programa;
+    e.tipos = &tipos;
+
+    for (size_t fi = 0; fi < programa.funciones.size(); ++fi) {
+        if (!revisar_tipos(e, fi)) {
+            motivo = e.motivo;
+            return false;
+        }
+    }
+
+    // el inicio del main depende de si el programa lee
+    for (const FuncionIR& f : programa.funciones)
+        for (const BloqueIR& bloque : f.bloques)
+            for (const InstrIR& instr : bloque.instrs)
+                if (instr.op == IR_LEE) e.usa_entrada = true;
+
+    std::ostringstream cuerpo;
+    for (size_t fi = 1; fi < programa.funciones.size(); ++fi)
+        cuerpo << firma(e, fi) << ";\n";
+    cuerpo << "\n";
+    for (size_t fi = 1; fi <= programa.funciones.size(); ++fi) {
+        // el programa principal va al final
+        size_t indice = fi % programa.funciones.size();
+        if (!generar_funcion(e, indice, cuerpo)) {
+            motivo = e.motivo;
+            return false;
+        }
+    }
+
+    std::ostringstream out;
+    out << "#include <iostream>\n#include <string>\n#include <cstdint>\n";
+    if (e.usa_entrada) out << "#include <cstdlib>\n";
+    out << "using namespace std;\n\n";
+    if (e.usa_entrada) out << prelude_entrada();
+    out << cuerpo.str();
+    codigo = out.str();
+    return true;
+}
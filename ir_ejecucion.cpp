@@ -0,0 +1,164 @@
+#include "ir.h"
+#include "segun.h"
+#include "intrinsecas.h"
+#include "memoria.h"
+#include "perfil.h"
+#include "pgo.h"
+#include "presupuesto.h"
+#include <set>
+#include <vector>
+
+// Interprete de la IR: cada funcion tiene un arreglo de registros, uno por
+// valor SSA, en vez de la tabla de variables que se copia en cada llamada
+static Value ejecutar_funcion(const ProgramaIR& programa, const FuncionIR& f, std::vector<Value>& args);
+
+static void reunir(const std::vector<Value>& r, const std::vector<int>& args, std::vector<Value>& valores) {
+    valores.clear();
+    for (int a : args) valores.push_back(r[a]);
+}
+
+// Marco de una llamada de la IR; se cierra aunque un limite o un error aislado
+// corte la ejecucion
+struct MarcoIR {
+    size_t bytes_marco;
+    const char* nombre;
+
+    MarcoIR(size_t bytes, const char* nombre_funcion) : bytes_marco(bytes), nombre(nombre_funcion) {
+        if (memoria_activa) memoria_entrar_llamada(bytes_marco);
+        if (perfil_activo) perfil_entrar(nombre);
+        bytes_marcos += bytes_marco;
+        profundidad_llamadas++;
+    }
+    ~MarcoIR() {
+        profundidad_llamadas--;
+        bytes_marcos -= bytes_marco;
+        if (perfil_activo) perfil_salir();
+        if (memoria_activa) memoria_salir_llamada(bytes_marco);
+    }
+};
+
+// --mem-stats: en la IR las variables son los registros de la funcion que corre.
+// Una lista que esta en varios registros se cuenta una vez.
+static void medir_registros(const std::vector<Value>& r) {
+    size_t bytes = 0;
+    std::set<const Lista*> listas;
+    for (const Value& v : r)
+        if (v.type != Value::LIST || listas.insert(v.asList().get()).second) bytes += bytes_valor(v);
+    memoria_variables(bytes);
+}
+
+static Value llamar(const ProgramaIR& programa, const InstrIR& instr, const std::vector<Value>& r) {
+    const FuncionIR& f = programa.funciones[instr.entero];
+    if (pgo_grabando) pgo_llamada(instr.sitio);
+    contar_paso();
+    std::vector<Value> args;
+    reunir(r, instr.args, args);
+
+    MarcoIR marco(f.num_valores * sizeof(Value), f.nombre.c_str());
+    return ejecutar_funcion(programa, f, args);
+}
+
+static Value ejecutar_funcion(const ProgramaIR& programa, const FuncionIR& f, std::vector<Value>& args) {
+    std::vector<Value> r(f.num_valores);
+    std::vector<Value> valores;
+    int b = 0, anterior = -1;
+    const std::vector<Value>* registros_quien_llama = registros_ir;
+    registros_ir = &r;
+
+    while (true) {
+        const BloqueIR& bloque = f.bloques[b];
+        const std::vector<InstrIR>& instrs = bloque.instrs;
+        size_t i = 0;
+
+        // las phi toman el argumento del bloque de donde se viene, todas a la vez
+        if (anterior >= 0) {
+            size_t k = 0;
+            while (k < bloque.preds.size() && bloque.preds[k] != anterior) ++k;
+            while (i < instrs.size() && instrs[i].op == IR_PHI) ++i;
+            if (i == 1) {
+                r[instrs[0].valor] = r[instrs[0].args[k]];
+            } else if (i > 1) {
+                valores.clear();
+                for (size_t p = 0; p < i; ++p) valores.push_back(r[instrs[p].args[k]]);
+                for (size_t p = 0; p < i; ++p) r[instrs[p].valor] = std::move(valores[p]);
+            }
+        }
+
+        for (; i < instrs.size(); ++i) {
+            const InstrIR& instr = instrs[i];
+            switch (instr.op) {
+                case IR_CONST: r[instr.valor] = instr.constante; break;
+                case IR_PARAM: r[instr.valor] = std::move(args[instr.entero]); break;
+                case IR_PHI: break;
+                case IR_COPIA: r[instr.valor] = r[instr.args[0]]; break;
+                case IR_BINOP:
+                    r[instr.valor] = operar_binop(instr.entero, r[instr.args[0]], r[instr.args[1]]);
+                    break;
+                case IR_CONCAT:
+                    reunir(r, instr.args, valores);
+                    r[instr.valor] = concatenar_partes(valores.data(), valores.size());
+                    if (memoria_activa) medir_registros(r);
+                    break;
+                case IR_LISTA:
+                    reunir(r, instr.args, valores);
+                    r[instr.valor] = crear_lista(valores.data(), valores.size());
+                    if (memoria_activa) medir_registros(r);
+                    break;
+                case IR_INDICE:
+                    r[instr.valor] = indexar_lista(r[instr.args[0]], r[instr.args[1]]);
+                    break;
+                case IR_ASIGNA:
+                    r[instr.valor] = valor_para_asignar(instr.texto, r[instr.args[0]], instr.variable);
+                    if (memoria_activa) medir_registros(r);
+                    break;
+                case IR_INTRINSECA:
+                    reunir(r, instr.args, valores);
+                    r[instr.valor] = instr.intrinseca->funcion(valores.data(), valores.size());
+                    if (memoria_activa) medir_registros(r);
+                    break;
+                case IR_LLAMADA: {
+                    Value resultado = llamar(programa, instr, r);
+                    if (instr.valor >= 0) r[instr.valor] = std::move(resultado);
+                    break;
+                }
+                case IR_IMPRIME: imprimir_valor(r[instr.args[0]]); break;
+                case IR_IMPRIME_PARTES:
+                    reunir(r, instr.args, valores);
+                    imprimir_partes(valores.data(), valores.size());
+                    break;
+                case IR_LEE:
+                    r[instr.valor] = leer_entrada(instr.texto, instr.variable);
+                    if (memoria_activa) medir_registros(r);
+                    break;
+                case IR_SALTO:
+                    anterior = b;
+                    b = instr.destinos[0];
+                    if (b <= anterior) contar_paso(); // todo ciclo tiene un salto hacia atras
+                    break;
+                case IR_SI: {
+                    bool cumple = es_verdadero(r[instr.args[0]]);
+                    if (pgo_grabando) pgo_rama(instr.sitio, cumple);
+                    anterior = b;
+                    b = cumple ? instr.destinos[0] : instr.destinos[1];
+                    if (b <= anterior) contar_paso();
+                    break;
+                }
+                case IR_SEGUN:
+                    anterior = b;
+                    b = instr.casos[instr.tabla->buscar(r[instr.args[0]])];
+                    if (b <= anterior) contar_paso();
+                    break;
+                case IR_DEVUELVE:
+                    registros_ir = registros_quien_llama;
+                    return r[instr.args[0]];
+            }
+        }
+    }
+}
+
+void ejecutar_ir(const ProgramaIR& programa) {
+    std::vector<Value> sin_args;
+    bytes_marcos += programa.funciones[0].num_valores * sizeof(Value);
+    ejecutar_funcion(programa, programa.funciones[0], sin_args);
+    bytes_marcos -= programa.funciones[0].num_valores * sizeof(Value);
+}
@@ -0,0 +1,480 @@
+#include "ir.h"
+#include "listas.h"
+#include "pgo.h"
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static TipoIR juntar_tipos(TipoIR a, TipoIR b) {
+    if (a == TIR_INDEF) return b;
+    if (b == TIR_INDEF) return a;
+    if (a == b) return a;
+    if ((a == TIR_INT || a == TIR_NUMERO) && (b == TIR_INT || b == TIR_NUMERO)) return TIR_NUMERO;
+    return TIR_DINAMICO;
+}
+
+static bool es_numero(TipoIR t) { return t == TIR_INT || t == TIR_NUMERO || t == TIR_FLOAT; }
+static bool es_entero(TipoIR t) { return t == TIR_INT || t == TIR_NUMERO; }
+static bool es_lista(TipoIR t) { return t == TIR_LISTA_INT || t == TIR_LISTA_FLOAT; }
+
+static TipoIR tipo_constante(const Value& v) {
+    switch (v.type) {
+        case Value::INT: return TIR_INT;
+        case Value::FLOAT: return TIR_FLOAT;
+        case Value::STRING: return TIR_STRING;
+        case Value::LIST: return v.asList()->es_float ? TIR_LISTA_FLOAT : TIR_LISTA_INT;
+        default: return TIR_NULO;
+    }
+}
+
+static TipoIR tipo_declarado(const std::string& tipo) {
+    if (tipo == "int") return TIR_INT;
+    if (tipo == "float") return TIR_FLOAT;
+    if (tipo == "string") return TIR_STRING;
+    if (tipo == "lista_int") return TIR_LISTA_INT;
+    if (tipo == "lista_float") return TIR_LISTA_FLOAT;
+    return TIR_DINAMICO;
+}
+
+// El valor pasa la revision de valor_para_asignar sin error
+static bool asignable(const std::string& tipo, TipoIR t) {
+    TipoIR destino = tipo_declarado(tipo);
+    if (destino == TIR_FLOAT) return es_numero(t);
+    if (destino == TIR_LISTA_FLOAT) return es_lista(t);
+    return destino == t && destino != TIR_DINAMICO;
+}
+
+// Mismas reglas que operar_binop
+static TipoIR tipo_binop(int op, TipoIR l, TipoIR r) {
+    if (l == TIR_INDEF || r == TIR_INDEF) return TIR_INDEF;
+    if (op == OP_EQ || op == OP_NEQ) return TIR_INT;
+    if (es_lista(l) || es_lista(r)) {
+        if (op != OP_PLUS && op != OP_MINUS && op != OP_MULT && op != OP_DIV) return TIR_DINAMICO;
+        if (!(es_lista(l) || es_numero(l)) || !(es_lista(r) || es_numero(r))) return TIR_DINAMICO;
+        bool es_float = op == OP_DIV || l == TIR_FLOAT || r == TIR_FLOAT ||
+                        l == TIR_LISTA_FLOAT || r == TIR_LISTA_FLOAT;
+        if (!es_float && (l == TIR_NUMERO || r == TIR_NUMERO)) return TIR_DINAMICO;
+        return es_float ? TIR_LISTA_FLOAT : TIR_LISTA_INT;
+    }
+    switch (op) {
+        case OP_PLUS:
+            if (l == TIR_STRING || r == TIR_STRING) {
+                bool ok = (l == TIR_STRING || es_numero(l)) && (r == TIR_STRING || es_numero(r));
+                return ok ? TIR_STRING : TIR_DINAMICO;
+            }
+            [[fallthrough]];
+        case OP_MINUS:
+        case OP_MULT:
+            if (!es_numero(l) || !es_numero(r)) return TIR_DINAMICO;
+            return (es_entero(l) && es_entero(r)) ? TIR_NUMERO : TIR_FLOAT;
+        case OP_DIV:
+            // int / int da int solo si la division es exacta
+            if (!es_numero(l) || !es_numero(r) || (es_entero(l) && es_entero(r))) return TIR_DINAMICO;
+            return TIR_FLOAT;
+        default:
+            return (es_numero(l) && es_numero(r)) ? TIR_INT : TIR_DINAMICO;
+    }
+}
+
+TiposIR inferir_tipos_ir(const ProgramaIR& programa) {
+    size_t n = programa.funciones.size();
+    TiposIR resultado;
+    std::vector<std::vector<TipoIR>>& tipos = resultado.valores;
+    std::vector<std::vector<TipoIR>>& params = resultado.params;
+    std::vector<TipoIR>& retornos = resultado.retornos;
+    tipos.resize(n);
+    params.resize(n);
+    retornos.assign(n, TIR_INDEF);
+    for (size_t f = 0; f < n; ++f) {
+        tipos[f].assign(programa.funciones[f].num_valores, TIR_INDEF);
+        params[f].assign(programa.funciones[f].params.size(), TIR_INDEF);
+    }
+
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        for (size_t f = 0; f < n; ++f) {
+            std::vector<TipoIR>& t = tipos[f];
+            for (const BloqueIR& bloque : programa.funciones[f].bloques) {
+                for (const InstrIR& instr : bloque.instrs) {
+                    TipoIR nuevo = TIR_INDEF;
+                    switch (instr.op) {
+                        case IR_CONST: nuevo = tipo_constante(instr.constante); break;
+                        case IR_PARAM: nuevo = params[f][instr.entero]; break;
+                        case IR_PHI:
+                            for (int a : instr.args) nuevo = juntar_tipos(nuevo, t[a]);
+                            break;
+                        case IR_COPIA: nuevo = t[instr.args[0]]; break;
+                        case IR_BINOP: nuevo = tipo_binop(instr.entero, t[instr.args[0]], t[instr.args[1]]); break;
+                        case IR_CONCAT: nuevo = TIR_STRING; break;
+                        case IR_LISTA: {
+                            // un int desbordado haria la lista de floats
+                            bool hay_float = false, todos_int = true, todos_numeros = true;
+                            for (int a : instr.args) {
+                                todos_numeros = todos_numeros && es_numero(t[a]);
+                                todos_int = todos_int && t[a] == TIR_INT;
+                                hay_float = hay_float || t[a] == TIR_FLOAT;
+                            }
+                            nuevo = !todos_numeros ? TIR_DINAMICO : todos_int ? TIR_LISTA_INT :
+                                    hay_float ? TIR_LISTA_FLOAT : TIR_DINAMICO;
+                            break;
+                        }
+                        case IR_INDICE: {
+                            TipoIR lista = t[instr.args[0]];
+                            nuevo = lista == TIR_LISTA_INT ? TIR_INT : lista == TIR_LISTA_FLOAT ? TIR_FLOAT :
+                                    lista == TIR_INDEF ? TIR_INDEF : TIR_DINAMICO;
+                            break;
+                        }
+                        case IR_ASIGNA:
+                        case IR_LEE:
+                            nuevo = tipo_declarado(instr.texto);
+                            break;
+                        case IR_INTRINSECA: nuevo = TIR_DINAMICO; break;
+                        case IR_LLAMADA: {
+                            nuevo = retornos[instr.entero];
+                            std::vector<TipoIR>& p = params[instr.entero];
+                            for (size_t i = 0; i < instr.args.size() && i < p.size(); ++i) {
+                                TipoIR junto = juntar_tipos(p[i], t[instr.args[i]]);
+                                if (junto != p[i]) { p[i] = junto; cambio = true; }
+                            }
+                            break;
+                        }
+                        case IR_DEVUELVE: {
+                            TipoIR junto = juntar_tipos(retornos[f], t[instr.args[0]]);
+                            if (junto != retornos[f]) { retornos[f] = junto; cambio = true; }
+                            break;
+                        }
+                        default: break;
+                    }
+                    if (instr.valor < 0) continue;
+                    TipoIR junto = juntar_tipos(t[instr.valor], nuevo);
+                    if (junto != t[instr.valor]) {
+                        t[instr.valor] = junto;
+                        cambio = true;
+                    }
+                }
+            }
+        }
+    }
+    return resultado;
+}
+
+// La instruccion se puede borrar si nadie usa su valor: no escribe, no llama
+// funciones del usuario y no puede terminar el programa ni escribir un error
+static bool sin_efectos(const InstrIR& instr, const std::vector<TipoIR>& t) {
+    switch (instr.op) {
+        case IR_CONST:
+        case IR_PARAM:
+        case IR_PHI:
+        case IR_COPIA:
+        case IR_CONCAT:
+            return true;
+        case IR_BINOP: {
+            TipoIR l = t[instr.args[0]], r = t[instr.args[1]];
+            if (instr.entero == OP_EQ || instr.entero == OP_NEQ) return true;
+            if (instr.entero == OP_PLUS && (l == TIR_STRING || r == TIR_STRING))
+                return (l == TIR_STRING || es_numero(l)) && (r == TIR_STRING || es_numero(r));
+            return es_numero(l) && es_numero(r);
+        }
+        case IR_LISTA:
+            for (int a : instr.args)
+                if (!es_numero(t[a])) return false;
+            return true;
+        case IR_ASIGNA:
+            return asignable(instr.texto, t[instr.args[0]]);
+        default:
+            return false;
+    }
+}
+
+static int buscar(std::vector<int>& reemplazo, int v) {
+    while (reemplazo[v] >= 0) v = reemplazo[v];
+    return v;
+}
+
+// Reescribe los usos con 'reemplazo' y quita las instrucciones reemplazadas
+static void aplicar_reemplazos(FuncionIR& f, std::vector<int>& reemplazo) {
+    for (BloqueIR& bloque : f.bloques) {
+        std::vector<InstrIR> quedan;
+        for (InstrIR& instr : bloque.instrs) {
+            if (instr.valor >= 0 && reemplazo[instr.valor] >= 0) continue;
+            for (int& a : instr.args) a = buscar(reemplazo, a);
+            quedan.push_back(std::move(instr));
+        }
+        bloque.instrs = std::move(quedan);
+    }
+}
+
+// Propagacion de copias: copias, phi triviales (todos los argumentos iguales)
+// y asignaciones a una variable del mismo tipo que el valor se reemplazan por
+// el valor original
+static void propagar_copias(ProgramaIR& programa) {
+    std::vector<std::vector<TipoIR>> tipos = inferir_tipos_ir(programa).valores;
+    for (size_t fi = 0; fi < programa.funciones.size(); ++fi) {
+        FuncionIR& f = programa.funciones[fi];
+        std::vector<int> reemplazo(f.num_valores, -1);
+        bool cambio = true;
+        while (cambio) {
+            cambio = false;
+            for (BloqueIR& bloque : f.bloques) {
+                for (InstrIR& instr : bloque.instrs) {
+                    if (instr.valor < 0 || reemplazo[instr.valor] >= 0) continue;
+                    int nuevo = -1;
+                    if (instr.op == IR_COPIA) {
+                        nuevo = buscar(reemplazo, instr.args[0]);
+                    } else if (instr.op == IR_PHI) {
+                        int unico = -1;
+                        bool trivial = true;
+                        for (int a : instr.args) {
+                            a = buscar(reemplazo, a);
+                            if (a == instr.valor) continue;
+                            if (unico < 0) unico = a;
+                            else if (a != unico) trivial = false;
+                        }
+                        if (trivial) nuevo = unico;
+                    } else if (instr.op == IR_ASIGNA) {
+                        int a = buscar(reemplazo, instr.args[0]);
+                        if (tipos[fi][a] == tipo_declarado(instr.texto) && tipos[fi][a] != TIR_DINAMICO)
+                            nuevo = a;
+                    }
+                    if (nuevo >= 0 && nuevo != instr.valor) {
+                        reemplazo[instr.valor] = nuevo;
+                        cambio = true;
+                    }
+                }
+            }
+        }
+        aplicar_reemplazos(f, reemplazo);
+    }
+}
+
+static std::vector<int> sucesores(const BloqueIR& bloque) {
+    std::vector<int> s;
+    if (bloque.instrs.empty()) return s;
+    const InstrIR& fin = bloque.instrs.back();
+    if (fin.op == IR_SALTO) s.push_back(fin.destinos[0]);
+    if (fin.op == IR_SI) s = {fin.destinos[0], fin.destinos[1]};
+    if (fin.op == IR_SEGUN) s = fin.casos;
+    return s;
+}
+
+static void postorden(const FuncionIR& f, int b, std::vector<bool>& visto, std::vector<int>& orden) {
+    visto[b] = true;
+    for (int s : sucesores(f.bloques[b]))
+        if (!visto[s]) postorden(f, s, visto, orden);
+    orden.push_back(b);
+}
+
+// Dominadores inmediatos (Cooper, Harvey y Kennedy: "A Simple, Fast Dominance Algorithm")
+static std::vector<int> dominadores(const FuncionIR& f) {
+    size_t n = f.bloques.size();
+    std::vector<bool> visto(n, false);
+    std::vector<int> orden;
+    postorden(f, 0, visto, orden);
+    std::vector<int> numero(n, -1);
+    for (size_t i = 0; i < orden.size(); ++i) numero[orden[i]] = (int)i;
+
+    std::vector<int> idom(n, -1);
+    idom[0] = 0;
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        for (auto it = orden.rbegin(); it != orden.rend(); ++it) {
+            int b = *it;
+            if (b == 0) continue;
+            int nuevo = -1;
+            for (int p : f.bloques[b].preds) {
+                if (idom[p] < 0) continue;
+                if (nuevo < 0) { nuevo = p; continue; }
+                int x = p, y = nuevo;
+                while (x != y) {
+                    while (numero[x] < numero[y]) x = idom[x];
+                    while (numero[y] < numero[x]) y = idom[y];
+                }
+                nuevo = x;
+            }
+            if (nuevo != idom[b]) {
+                idom[b] = nuevo;
+                cambio = true;
+            }
+        }
+    }
+    return idom;
+}
+
+static bool numerable(OpIR op) {
+    switch (op) {
+        case IR_CONST:
+        case IR_PHI:
+        case IR_BINOP:
+        case IR_CONCAT:
+        case IR_LISTA:
+        case IR_INDICE:
+        case IR_ASIGNA:
+        case IR_INTRINSECA:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Dos instrucciones con la misma clave calculan el mismo valor
+static std::string clave(const InstrIR& instr, int bloque) {
+    std::ostringstream k;
+    k << instr.op << "|" << instr.entero << "|" << instr.texto.size() << ":" << instr.texto << "|"
+      << (const void*)instr.intrinseca << "|";
+    if (instr.op == IR_PHI) k << "b" << bloque << "|";
+    if (instr.op == IR_CONST) {
+        const Value& c = instr.constante;
+        k << c.type << ":";
+        if (c.type == Value::INT) k << c.asInt();
+        else if (c.type == Value::FLOAT) k << std::hexfloat << c.asFloat();
+        else if (c.type == Value::STRING) k << c.asString().size() << ":" << c.asString();
+    }
+    std::vector<int> args = instr.args;
+    // == y != dan lo mismo con los operandos al reves
+    if (instr.op == IR_BINOP && (instr.entero == OP_EQ || instr.entero == OP_NEQ) && args[0] > args[1])
+        std::swap(args[0], args[1]);
+    for (int a : args) k << "," << a;
+    return k.str();
+}
+
+static void numerar_bloque(FuncionIR& f, int b, const std::vector<std::vector<int>>& hijos,
+                           std::map<std::string, int>& tabla, std::vector<int>& reemplazo) {
+    std::vector<std::string> agregadas;
+    for (InstrIR& instr : f.bloques[b].instrs) {
+        for (int& a : instr.args) a = buscar(reemplazo, a);
+        if (instr.valor < 0 || !numerable(instr.op)) continue;
+        std::string k = clave(instr, b);
+        auto it = tabla.find(k);
+        if (it != tabla.end()) {
+            reemplazo[instr.valor] = it->second;
+        } else {
+            tabla[k] = instr.valor;
+            agregadas.push_back(k);
+        }
+    }
+    for (int hijo : hijos[b])
+        numerar_bloque(f, hijo, hijos, tabla, reemplazo);
+    for (const std::string& k : agregadas) tabla.erase(k);
+}
+
+// GVN/CSE sobre el arbol de dominadores: un calculo repetido se reemplaza por
+// el que lo domina
+static void numerar_valores(ProgramaIR& programa) {
+    for (FuncionIR& f : programa.funciones) {
+        std::vector<int> idom = dominadores(f);
+        std::vector<std::vector<int>> hijos(f.bloques.size());
+        for (size_t b = 1; b < f.bloques.size(); ++b)
+            if (idom[b] >= 0) hijos[idom[b]].push_back((int)b);
+
+        std::vector<int> reemplazo(f.num_valores, -1);
+        std::map<std::string, int> tabla;
+        numerar_bloque(f, 0, hijos, tabla, reemplazo);
+        aplicar_reemplazos(f, reemplazo);
+    }
+}
+
+// Eliminacion de codigo muerto: se marcan las instrucciones con efectos y
+// todo lo que usan; el resto se borra
+static void eliminar_muertos(ProgramaIR& programa) {
+    std::vector<std::vector<TipoIR>> tipos = inferir_tipos_ir(programa).valores;
+    for (size_t fi = 0; fi < programa.funciones.size(); ++fi) {
+        FuncionIR& f = programa.funciones[fi];
+        std::vector<const InstrIR*> definicion(f.num_valores, nullptr);
+        std::vector<bool> vivo(f.num_valores, false);
+        std::vector<int> pendientes;
+        for (const BloqueIR& bloque : f.bloques) {
+            for (const InstrIR& instr : bloque.instrs) {
+                if (instr.valor >= 0) definicion[instr.valor] = &instr;
+                if (instr.valor < 0 || !sin_efectos(instr, tipos[fi])) {
+                    for (int a : instr.args) pendientes.push_back(a);
+                    if (instr.valor >= 0) vivo[instr.valor] = true;
+                }
+            }
+        }
+        while (!pendientes.empty()) {
+            int v = pendientes.back();
+            pendientes.pop_back();
+            if (vivo[v]) continue;
+            vivo[v] = true;
+            if (definicion[v])
+                for (int a : definicion[v]->args) pendientes.push_back(a);
+        }
+        for (BloqueIR& bloque : f.bloques) {
+            std::vector<InstrIR> quedan;
+            for (InstrIR& instr : bloque.instrs)
+                if (instr.valor < 0 || vivo[instr.valor]) quedan.push_back(std::move(instr));
+            bloque.instrs = std::move(quedan);
+        }
+    }
+}
+
+// Orden de bloques segun el perfil: desde la entrada se sigue siempre el
+// sucesor mas probable que no este puesto, asi el camino caliente queda seguido
+// (en el C++ generado, sin saltos). Las phi no cambian: los predecesores
+// conservan su orden y solo se renumeran.
+static void ordenar_bloques(FuncionIR& f) {
+    size_t n = f.bloques.size();
+    std::vector<int> orden, nuevo(n, -1);
+    size_t siguiente = 0;
+    int b = 0;
+    while (orden.size() < n) {
+        nuevo[b] = (int)orden.size();
+        orden.push_back(b);
+
+        std::vector<int> s = sucesores(f.bloques[b]);
+        if (s.size() == 2 && f.bloques[b].instrs.back().op == IR_SI) {
+            double p = pgo_probabilidad(f.bloques[b].instrs.back().sitio);
+            if (p >= 0 && p < 0.5) std::swap(s[0], s[1]);
+        }
+        b = -1;
+        for (int candidato : s) {
+            if (nuevo[candidato] < 0) {
+                b = candidato;
+                break;
+            }
+        }
+        if (b < 0) {
+            while (siguiente < n && nuevo[siguiente] >= 0) ++siguiente;
+            if (siguiente == n) break;
+            b = (int)siguiente;
+        }
+    }
+
+    std::vector<BloqueIR> bloques(n);
+    for (size_t i = 0; i < n; ++i) {
+        BloqueIR& bloque = bloques[nuevo[i]];
+        bloque = std::move(f.bloques[i]);
+        for (int& p : bloque.preds) p = nuevo[p];
+        for (InstrIR& instr : bloque.instrs) {
+            if (instr.op == IR_SALTO || instr.op == IR_SI) instr.destinos[0] = nuevo[instr.destinos[0]];
+            if (instr.op == IR_SI) instr.destinos[1] = nuevo[instr.destinos[1]];
+            for (int& caso : instr.casos) caso = nuevo[caso];
+        }
+    }
+    f.bloques = std::move(bloques);
+}
+
+static void mostrar(const ProgramaIR& programa, const char* titulo) {
+    if (!dump_ir) return;
+    std::cout << "--- IR: " << titulo << " ---\n";
+    imprimir_ir(programa, std::cout);
+}
+
+void optimizar_ir(ProgramaIR& programa) {
+    mostrar(programa, "construida");
+    propagar_copias(programa);
+    mostrar(programa, "despues de propagar copias");
+    numerar_valores(programa);
+    propagar_copias(programa); // GVN puede dejar phi con argumentos iguales
+    mostrar(programa, "despues de GVN/CSE");
+    eliminar_muertos(programa);
+    mostrar(programa, "despues de eliminar codigo muerto");
+    if (pgo_cargado()) {
+        for (FuncionIR& f : programa.funciones) ordenar_bloques(f);
+        mostrar(programa, "bloques ordenados segun el perfil");
+    }
+}
@@ -0,0 +1,243 @@
+#include "listas.h"
+#include "presupuesto.h"
+#include <cstring>
+#include <memory>
+#include <sstream>
+
+// Con GCC/Clang los nucleos usan vectores de 128 bits (SSE en x86-64, NEON en ARM).
+// En otros compiladores queda solo el ciclo escalar.
+#if defined(__GNUC__) || defined(__clang__)
+#define CHL_SIMD 1
+typedef int i32x4 __attribute__((vector_size(16)));
+typedef float f32x4 __attribute__((vector_size(16)));
+#else
+typedef int i32x4;
+typedef float f32x4;
+#endif
+
+static const size_t ANCHO = 4;
+
+template <typename V, typename T>
+static V cargar(const T* p) {
+    V v;
+    std::memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <typename V, typename T>
+static void guardar(T* p, const V& v) {
+    std::memcpy(p, &v, sizeof(V));
+}
+
+template <typename T, typename V>
+static T suma(const T* datos, size_t n) {
+    size_t i = 0;
+    T s = 0;
+#ifdef CHL_SIMD
+    V acc = {};
+    for (; i + ANCHO <= n; i += ANCHO)
+        acc += cargar<V>(datos + i);
+    for (size_t k = 0; k < ANCHO; ++k) s += acc[k];
+#endif
+    for (; i < n; ++i) s += datos[i];
+    return s;
+}
+
+// Minimo (o maximo) de una lista no vacia
+template <typename T, typename V, bool MAXIMO>
+static T extremo(const T* datos, size_t n) {
+    size_t i = 0;
+    T m = datos[0];
+#ifdef CHL_SIMD
+    if (n >= ANCHO) {
+        V acc = cargar<V>(datos);
+        for (i = ANCHO; i + ANCHO <= n; i += ANCHO) {
+            V v = cargar<V>(datos + i);
+            acc = MAXIMO ? (v > acc ? v : acc) : (v < acc ? v : acc);
+        }
+        m = acc[0];
+        for (size_t k = 1; k < ANCHO; ++k)
+            if (MAXIMO ? acc[k] > m : acc[k] < m) m = acc[k];
+    }
+#endif
+    for (; i < n; ++i)
+        if (MAXIMO ? datos[i] > m : datos[i] < m) m = datos[i];
+    return m;
+}
+
+template <typename T, typename V>
+static T producto_punto(const T* a, const T* b, size_t n) {
+    size_t i = 0;
+    T s = 0;
+#ifdef CHL_SIMD
+    V acc = {};
+    for (; i + ANCHO <= n; i += ANCHO)
+        acc += cargar<V>(a + i) * cargar<V>(b + i);
+    for (size_t k = 0; k < ANCHO; ++k) s += acc[k];
+#endif
+    for (; i < n; ++i) s += a[i] * b[i];
+    return s;
+}
+
+// Misma regla que el interprete: dividir por cero da 0
+template <int OP, typename A>
+static A aplicar(const A& x, const A& y) {
+    switch (OP) {
+        case OP_PLUS: return x + y;
+        case OP_MINUS: return x - y;
+        case OP_MULT: return x * y;
+        default: return y != 0 ? x / y : A{};
+    }
+}
+
+template <typename T, typename V, int OP>
+static void operar_bucle(const T* a, size_t paso_a, const T* b, size_t paso_b, T* dst, size_t n) {
+    size_t i = 0;
+#ifdef CHL_SIMD
+    V ka = V{} + a[0];
+    V kb = V{} + b[0];
+    for (; i + ANCHO <= n; i += ANCHO) {
+        V x = paso_a ? cargar<V>(a + i) : ka;
+        V y = paso_b ? cargar<V>(b + i) : kb;
+        guardar(dst + i, aplicar<OP>(x, y));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = aplicar<OP>(a[i * paso_a], b[i * paso_b]);
+}
+
+template <typename T, typename V>
+static void operar(int op, const T* a, size_t paso_a, const T* b, size_t paso_b, T* dst, size_t n) {
+    if (n == 0) return;
+    switch (op) {
+        case OP_PLUS: operar_bucle<T, V, OP_PLUS>(a, paso_a, b, paso_b, dst, n); break;
+        case OP_MINUS: operar_bucle<T, V, OP_MINUS>(a, paso_a, b, paso_b, dst, n); break;
+        case OP_MULT: operar_bucle<T, V, OP_MULT>(a, paso_a, b, paso_b, dst, n); break;
+        case OP_DIV: operar_bucle<T, V, OP_DIV>(a, paso_a, b, paso_b, dst, n); break;
+    }
+}
+
+int suma_enteros(const int* datos, size_t n) { return suma<int, i32x4>(datos, n); }
+float suma_flotantes(const float* datos, size_t n) { return suma<float, f32x4>(datos, n); }
+int minimo_enteros(const int* datos, size_t n) { return extremo<int, i32x4, false>(datos, n); }
+float minimo_flotantes(const float* datos, size_t n) { return extremo<float, f32x4, false>(datos, n); }
+int maximo_enteros(const int* datos, size_t n) { return extremo<int, i32x4, true>(datos, n); }
+float maximo_flotantes(const float* datos, size_t n) { return extremo<float, f32x4, true>(datos, n); }
+int producto_punto_enteros(const int* a, const int* b, size_t n) { return producto_punto<int, i32x4>(a, b, n); }
+float producto_punto_flotantes(const float* a, const float* b, size_t n) { return producto_punto<float, f32x4>(a, b, n); }
+
+void operar_enteros(int op, const int* a, size_t paso_a, const int* b, size_t paso_b, int* dst, size_t n) {
+    operar<int, i32x4>(op, a, paso_a, b, paso_b, dst, n);
+}
+
+void operar_flotantes(int op, const float* a, size_t paso_a, const float* b, size_t paso_b, float* dst, size_t n) {
+    operar<float, f32x4>(op, a, paso_a, b, paso_b, dst, n);
+}
+
+// Copia de los elementos como flotantes (para mezclar listita con numerito_con_punto)
+static std::vector<float> como_flotantes(const Lista& lista) {
+    if (lista.es_float) return lista.flotantes;
+    return std::vector<float>(lista.enteros.begin(), lista.enteros.end());
+}
+
+Value rango_lista(int n) {
+    reservar_memoria(sizeof(Lista) + (size_t)n * sizeof(int));
+    auto lista = std::make_shared<Lista>();
+    lista->enteros.resize(n);
+    for (int i = 0; i < n; ++i) lista->enteros[i] = i;
+    return Value(lista);
+}
+
+Value sumatoria_lista(const Lista& xs) {
+    return xs.es_float ? Value(suma_flotantes(xs.flotantes.data(), xs.largo()))
+                       : Value(suma_enteros(xs.enteros.data(), xs.largo()));
+}
+
+Value extremo_lista(const Lista& xs, bool maximo) {
+    if (xs.largo() == 0) {
+        error_ejecucion(std::string(maximo ? "maximo" : "minimo") + " de una lista vacia");
+    }
+    if (xs.es_float)
+        return Value(maximo ? maximo_flotantes(xs.flotantes.data(), xs.largo())
+                            : minimo_flotantes(xs.flotantes.data(), xs.largo()));
+    return Value(maximo ? maximo_enteros(xs.enteros.data(), xs.largo())
+                        : minimo_enteros(xs.enteros.data(), xs.largo()));
+}
+
+Value producto_punto_listas(const Lista& xs, const Lista& ys) {
+    size_t n = xs.largo();
+    if (ys.largo() != n) {
+        error_ejecucion("producto_punto con listas de distinto largo");
+    }
+    if (!xs.es_float && !ys.es_float)
+        return Value(producto_punto_enteros(xs.enteros.data(), ys.enteros.data(), n));
+    std::vector<float> a = como_flotantes(xs);
+    std::vector<float> b = como_flotantes(ys);
+    return Value(producto_punto_flotantes(a.data(), b.data(), n));
+}
+
+Value operar_con_listas(int op, const Value& lhs, const Value& rhs) {
+    if (op != OP_PLUS && op != OP_MINUS && op != OP_MULT && op != OP_DIV) {
+        error_ejecucion("Operacion no soportada para listas");
+    }
+    for (const Value* v : {&lhs, &rhs}) {
+        if (v->type != Value::LIST && v->type != Value::INT && v->type != Value::FLOAT) {
+            error_ejecucion("Operacion aritmetica no soportada para estos tipos");
+        }
+    }
+
+    size_t n = (lhs.type == Value::LIST) ? lhs.asList()->largo() : rhs.asList()->largo();
+    if (lhs.type == Value::LIST && rhs.type == Value::LIST && rhs.asList()->largo() != n) {
+        error_ejecucion("Operacion entre listas de distinto largo");
+    }
+
+    // Igual que con escalares, la division siempre produce flotantes
+    bool es_float = op == OP_DIV;
+    for (const Value* v : {&lhs, &rhs})
+        es_float = es_float || v->type == Value::FLOAT || (v->type == Value::LIST && v->asList()->es_float);
+
+    reservar_memoria(sizeof(Lista) + n * sizeof(float));
+    auto res = std::make_shared<Lista>();
+    res->es_float = es_float;
+    size_t paso_a = (lhs.type == Value::LIST) ? 1 : 0;
+    size_t paso_b = (rhs.type == Value::LIST) ? 1 : 0;
+
+    if (!es_float) {
+        int ka = paso_a ? 0 : lhs.asInt();
+        int kb = paso_b ? 0 : rhs.asInt();
+        const int* a = paso_a ? lhs.asList()->enteros.data() : &ka;
+        const int* b = paso_b ? rhs.asList()->enteros.data() : &kb;
+        res->enteros.resize(n);
+        operar_enteros(op, a, paso_a, b, paso_b, res->enteros.data(), n);
+        return Value(res);
+    }
+
+    std::vector<float> va, vb;
+    float ka = 0, kb = 0;
+    if (paso_a) va = como_flotantes(*lhs.asList());
+    else ka = (lhs.type == Value::FLOAT) ? lhs.asFloat() : lhs.asInt();
+    if (paso_b) vb = como_flotantes(*rhs.asList());
+    else kb = (rhs.type == Value::FLOAT) ? rhs.asFloat() : rhs.asInt();
+
+    res->flotantes.resize(n);
+    operar_flotantes(op, paso_a ? va.data() : &ka, paso_a, paso_b ? vb.data() : &kb, paso_b,
+                     res->flotantes.data(), n);
+    return Value(res);
+}
+
+bool listas_iguales(const Lista& a, const Lista& b) {
+    if (a.es_float != b.es_float) return false;
+    return a.es_float ? a.flotantes == b.flotantes : a.enteros == b.enteros;
+}
+
+std::string lista_a_texto(const Lista& lista) {
+    std::ostringstream out;
+    out << "[";
+    for (size_t i = 0; i < lista.largo(); ++i) {
+        if (i > 0) out << ", ";
+        if (lista.es_float) out << lista.flotantes[i];
+        else out << lista.enteros[i];
+    }
+    out << "]";
+    return out.str();
+}
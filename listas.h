@@ -0,0 +1,42 @@
+#ifndef LISTAS_H
+#define LISTAS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ast.h"
+
+// Lista contigua de numeros. Una listita guarda enteros y una
+// listita_con_punto guarda flotantes; solo se usa uno de los dos vectores.
+struct Lista {
+    bool es_float = false;
+    std::vector<int> enteros;
+    std::vector<float> flotantes;
+
+    size_t largo() const { return es_float ? flotantes.size() : enteros.size(); }
+};
+
+// Nucleos SIMD sobre arreglos contiguos
+int suma_enteros(const int* datos, size_t n);
+float suma_flotantes(const float* datos, size_t n);
+int minimo_enteros(const int* datos, size_t n);
+float minimo_flotantes(const float* datos, size_t n);
+int maximo_enteros(const int* datos, size_t n);
+float maximo_flotantes(const float* datos, size_t n);
+int producto_punto_enteros(const int* a, const int* b, size_t n);
+float producto_punto_flotantes(const float* a, const float* b, size_t n);
+
+// dst[i] = a[i] op b[i]. Con paso_b == 0 el lado b es un escalar repetido.
+void operar_enteros(int op, const int* a, size_t paso_a, const int* b, size_t paso_b, int* dst, size_t n);
+void operar_flotantes(int op, const float* a, size_t paso_a, const float* b, size_t paso_b, float* dst, size_t n);
+
+// Operaciones sobre valores del interprete
+Value rango_lista(int n);
+Value sumatoria_lista(const Lista& xs);
+Value extremo_lista(const Lista& xs, bool maximo);
+Value producto_punto_listas(const Lista& xs, const Lista& ys);
+Value operar_con_listas(int op, const Value& lhs, const Value& rhs);
+bool listas_iguales(const Lista& a, const Lista& b);
+std::string lista_a_texto(const Lista& lista);
+
+#endif
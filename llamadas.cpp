@@ -0,0 +1,256 @@
+#include "ast.h"
+#include "pgo.h"
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+int inline_max_nodos = 20;
+int inline_max_sitios = 1000;
+bool reporte_optimizador = false;
+
+// Nodo del grafo de llamadas: una funcion del usuario y a quienes llama
+struct InfoFuncion {
+    AST* def = nullptr;
+    int definiciones = 0;
+    std::set<std::string> llama;
+    bool recursiva = false;
+    int inline_hechos = 0;
+    int inline_calientes = 0; // de inline_hechos, los que el perfil marco calientes
+};
+
+static std::map<std::string, InfoFuncion> grafo;
+
+// Llamadas a funciones del usuario dentro de 'tree', sin entrar a definiciones anidadas
+static void recolectar_llamadas(AST* tree, std::set<std::string>& llamadas) {
+    if (!tree || tree->type == NODE_FUNC_DEF) return;
+    if (tree->type == NODE_FUNC_CALL && !tree->data.func_call.intrinseca)
+        llamadas.insert(tree->data.func_call.name);
+    for (AST** hijo : ast_hijos(tree))
+        recolectar_llamadas(*hijo, llamadas);
+}
+
+static void agregar_definiciones(AST* tree) {
+    if (!tree) return;
+    if (tree->type == NODE_FUNC_DEF) {
+        InfoFuncion& info = grafo[tree->data.func_def.name];
+        info.def = tree;
+        info.definiciones++;
+        recolectar_llamadas(tree->data.func_def.body, info.llama);
+    }
+    for (AST** hijo : ast_hijos(tree))
+        agregar_definiciones(*hijo);
+}
+
+static void alcanzables(const std::string& nombre, std::set<std::string>& vistas) {
+    if (vistas.count(nombre) || !grafo.count(nombre)) return;
+    vistas.insert(nombre);
+    for (const std::string& llamada : grafo[nombre].llama)
+        alcanzables(llamada, vistas);
+}
+
+static void construir_grafo(AST* tree) {
+    grafo.clear();
+    agregar_definiciones(tree);
+    for (auto& [nombre, info] : grafo) {
+        std::set<std::string> vistas;
+        for (const std::string& llamada : info.llama)
+            alcanzables(llamada, vistas);
+        info.recursiva = vistas.count(nombre) > 0;
+    }
+}
+
+static int contar_nodos(AST* tree) {
+    if (!tree) return 0;
+    int n = 1;
+    for (AST** hijo : ast_hijos(tree)) n += contar_nodos(*hijo);
+    return n;
+}
+
+// Expresion sin efectos: no asigna, no lee input y no llama funciones del usuario
+// (una funcion llamada veria las variables del que la llama, que cambian al hacer inline)
+static bool es_pura(AST* tree) {
+    if (!tree) return true;
+    switch (tree->type) {
+        case NODE_INT:
+        case NODE_FLOAT:
+        case NODE_STRING:
+        case NODE_ID:
+        case NODE_BINOP:
+        case NODE_CONCAT:
+        case NODE_LIST:
+        case NODE_INDEX:
+        case NODE_ARGS:
+            break;
+        case NODE_FUNC_CALL:
+            if (!tree->data.func_call.intrinseca) return false;
+            break;
+        default:
+            return false;
+    }
+    for (AST** hijo : ast_hijos(tree))
+        if (!es_pura(*hijo)) return false;
+    return true;
+}
+
+static bool es_trivial(AST* tree) {
+    return tree->type == NODE_INT || tree->type == NODE_FLOAT ||
+           tree->type == NODE_STRING || tree->type == NODE_ID;
+}
+
+// Un literal no puede fallar al evaluarse; hasta una variable puede no existir
+static bool es_literal(AST* tree) {
+    return tree->type == NODE_INT || tree->type == NODE_FLOAT || tree->type == NODE_STRING;
+}
+
+static void usos_de(AST* tree, const std::string& nombre, int& usos, bool& aparece) {
+    if (!tree) return;
+    if (tree->type == NODE_ID && nombre == tree->data.id) {
+        usos++;
+        aparece = true;
+    }
+    for (AST** hijo : ast_hijos(tree))
+        usos_de(*hijo, nombre, usos, aparece);
+}
+
+// Expresion que se puede copiar en el lugar de la llamada: el cuerpo es solo
+// 'devuelve_la_wa expr' con expr pura y pequena. Con un perfil cargado las
+// llamadas que nunca se hicieron no se copian, y las calientes aceptan funciones
+// mas grandes y no cuentan para inline_max_sitios. Al grabar un perfil no se
+// hace inline, asi cada llamada queda contada en su sitio.
+static AST* expresion_inline(const InfoFuncion& info, int sitio, bool& caliente) {
+    if (pgo_grabando || inline_max_nodos <= 0 || info.definiciones != 1 || info.recursiva) return nullptr;
+    caliente = pgo_llamada_caliente(sitio);
+    if (pgo_veces(sitio) == 0) return nullptr;
+    if (!caliente && info.inline_hechos - info.inline_calientes >= inline_max_sitios) return nullptr;
+    int max_nodos = caliente ? inline_max_nodos * PGO_FACTOR_INLINE : inline_max_nodos;
+    AST* body = info.def->data.func_def.body;
+    if (!body || body->type != NODE_RETURN) return nullptr;
+    AST* expr = body->data.ret.expr;
+    if (!expr || !es_pura(expr) || contar_nodos(expr) > max_nodos) return nullptr;
+    return expr;
+}
+
+// Copia de una expresion pura reemplazando los parametros por los argumentos
+static AST* clonar(AST* tree, const std::map<std::string, AST*>& reemplazos) {
+    if (!tree) return nullptr;
+    if (tree->type == NODE_ID) {
+        auto it = reemplazos.find(tree->data.id);
+        if (it != reemplazos.end()) return clonar(it->second, {});
+    }
+
+    AST* copia = new AST(*tree);
+    switch (tree->type) {
+        case NODE_ID: copia->data.id = strdup(tree->data.id); break;
+        case NODE_STRING: copia->data.strval = strdup(tree->data.strval); break;
+        case NODE_FUNC_CALL: copia->data.func_call.name = strdup(tree->data.func_call.name); break;
+        case NODE_ARGS: copia->data.args.values = new std::vector<AST*>(*tree->data.args.values); break;
+        case NODE_CONCAT: copia->data.concat.partes = new std::vector<AST*>(*tree->data.concat.partes); break;
+        case NODE_LIST: copia->data.lista.elementos = new std::vector<AST*>(*tree->data.lista.elementos); break;
+        default: break;
+    }
+    for (AST** hijo : ast_hijos(copia))
+        *hijo = clonar(*hijo, reemplazos);
+    return copia;
+}
+
+static AST* intentar_inline(AST* llamada) {
+    auto it = grafo.find(llamada->data.func_call.name);
+    if (it == grafo.end()) return nullptr;
+    InfoFuncion& info = it->second;
+    bool caliente = false;
+    AST* expr = expresion_inline(info, llamada->sitio, caliente);
+    if (!expr) return nullptr;
+
+    const std::vector<std::string>& params = *(info.def->data.func_def.params->data.params.names);
+    const std::vector<AST*>& args = *(llamada->data.func_call.args->data.args.values);
+    if (params.size() != args.size()) return nullptr;
+
+    std::map<std::string, AST*> reemplazos;
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (!es_pura(args[i])) return nullptr;
+        // los argumentos se evaluan con los parametros anteriores ya definidos,
+        // asi que un argumento que nombra un parametro no se puede mover
+        for (const std::string& p : params) {
+            int usos_arg = 0;
+            bool aparece = false;
+            usos_de(args[i], p, usos_arg, aparece);
+            if (aparece) return nullptr;
+        }
+        int usos = 0;
+        bool aparece = false;
+        usos_de(expr, params[i], usos, aparece);
+        if (usos > 1 && !es_trivial(args[i])) return nullptr;
+        // un argumento que no se usa desaparece de la copia: solo si evaluarlo no
+        // podia terminar el programa (p. ej. xs[7] fuera de rango)
+        if (usos == 0 && !es_literal(args[i])) return nullptr;
+        reemplazos[params[i]] = args[i];
+    }
+
+    info.inline_hechos++;
+    if (caliente) info.inline_calientes++;
+    return clonar(expr, reemplazos);
+}
+
+static void hacer_inline(AST** slot) {
+    AST* tree = *slot;
+    if (!tree) return;
+    for (AST** hijo : ast_hijos(tree))
+        hacer_inline(hijo);
+    if (tree->type == NODE_FUNC_CALL && !tree->data.func_call.intrinseca) {
+        AST* reemplazo = intentar_inline(tree);
+        if (reemplazo) *slot = reemplazo;
+    }
+}
+
+// Quita las definiciones que no se alcanzan desde el programa principal
+static void eliminar_muertas(AST** slot, const std::set<std::string>& vivas, std::vector<std::string>& eliminadas) {
+    AST* tree = *slot;
+    if (!tree) return;
+    if (tree->type == NODE_FUNC_DEF) {
+        if (!vivas.count(tree->data.func_def.name)) {
+            eliminadas.push_back(tree->data.func_def.name);
+            *slot = nullptr;
+            return;
+        }
+    }
+    for (AST** hijo : ast_hijos(tree))
+        eliminar_muertas(hijo, vivas, eliminadas);
+    if (tree->type == NODE_SEQ && (!tree->data.seq.first || !tree->data.seq.second))
+        *slot = tree->data.seq.first ? tree->data.seq.first : tree->data.seq.second;
+}
+
+AST* optimizar_llamadas(AST* tree) {
+    construir_grafo(tree);
+    hacer_inline(&tree);
+
+    // el inline pudo dejar funciones sin llamadas
+    std::map<std::string, std::pair<int, int>> inline_hechos;
+    for (const auto& [nombre, info] : grafo)
+        if (info.inline_hechos > 0) inline_hechos[nombre] = {info.inline_hechos, info.inline_calientes};
+    construir_grafo(tree);
+
+    std::set<std::string> raices, vivas;
+    recolectar_llamadas(tree, raices);
+    for (const std::string& nombre : raices)
+        alcanzables(nombre, vivas);
+
+    std::vector<std::string> eliminadas;
+    eliminar_muertas(&tree, vivas, eliminadas);
+
+    if (reporte_optimizador) {
+        std::cerr << "--- Optimizador de llamadas ---\n";
+        for (const auto& [nombre, veces] : inline_hechos) {
+            std::cerr << "inline: " << nombre << " (" << veces.first << " llamadas";
+            if (veces.second > 0) std::cerr << ", " << veces.second << " calientes";
+            std::cerr << ")\n";
+        }
+        for (const std::string& nombre : eliminadas)
+            std::cerr << "eliminada: " << nombre << "\n";
+        for (const auto& [nombre, info] : grafo)
+            if (info.recursiva) std::cerr << "recursiva: " << nombre << "\n";
+    }
+    return tree;
+}
@@ -0,0 +1,219 @@
+#include "lote.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Los registros se guardan por columna: columnas[c][fila]
+static std::vector<std::string> nombres;
+static std::vector<std::vector<std::string>> columnas;
+static size_t filas = 0;
+// Columnas de cada variable, en el orden del archivo
+static std::map<std::string, std::vector<size_t>> columnas_de;
+
+// Registro que ejecuta este hilo y cuantas veces ya leyo cada variable
+static thread_local size_t fila_actual = 0;
+static thread_local std::map<std::string, size_t> lecturas;
+
+// Campos de una linea separados por comas. Un campo entre comillas puede tener
+// comas, y "" adentro es una comilla. Devuelve false si una comilla no se cierra.
+static bool separar_campos(const std::string& linea, std::vector<std::string>& campos) {
+    campos.clear();
+    std::string campo;
+    bool comillas = false;
+    for (size_t i = 0; i < linea.size(); ++i) {
+        char c = linea[i];
+        if (comillas) {
+            if (c == '"' && i + 1 < linea.size() && linea[i + 1] == '"') {
+                campo += '"';
+                ++i;
+            } else if (c == '"') {
+                comillas = false;
+            } else {
+                campo += c;
+            }
+        } else if (c == '"') {
+            comillas = true;
+        } else if (c == ',') {
+            campos.push_back(campo);
+            campo.clear();
+        } else {
+            campo += c;
+        }
+    }
+    campos.push_back(campo);
+    return !comillas;
+}
+
+static bool cargar_registros(const char* archivo) {
+    std::ifstream in(archivo);
+    if (!in) {
+        std::cerr << "No se pudo abrir el archivo: " << archivo << std::endl;
+        return false;
+    }
+    std::string linea;
+    std::vector<std::string> campos;
+    size_t numero = 0;
+    bool encabezado = true;
+    while (std::getline(in, linea)) {
+        numero++;
+        if (!linea.empty() && linea.back() == '\r') linea.pop_back();
+        if (linea.empty()) continue;
+        if (!separar_campos(linea, campos)) {
+            std::cerr << "Error: comillas sin cerrar en la linea " << numero << " de " << archivo << "\n";
+            return false;
+        }
+        if (encabezado) {
+            nombres = campos;
+            columnas.assign(nombres.size(), {});
+            for (size_t c = 0; c < nombres.size(); ++c)
+                columnas_de[nombres[c]].push_back(c);
+            encabezado = false;
+            continue;
+        }
+        if (campos.size() != nombres.size()) {
+            std::cerr << "Error: la linea " << numero << " de " << archivo << " tiene " << campos.size()
+                      << " campos y el encabezado " << nombres.size() << "\n";
+            return false;
+        }
+        for (size_t c = 0; c < campos.size(); ++c)
+            columnas[c].push_back(std::move(campos[c]));
+        filas++;
+    }
+    if (encabezado) {
+        std::cerr << "Error: " << archivo << " no tiene encabezado\n";
+        return false;
+    }
+    return true;
+}
+
+// Variables que el programa lee con lee_la_wa (tambien dentro de funciones)
+static void recolectar_lecturas(AST* tree, std::set<std::string>& leidas) {
+    if (!tree) return;
+    if (tree->type == NODE_INPUT) leidas.insert(tree->data.input.variable->data.id);
+    for (AST** hijo : ast_hijos(tree))
+        recolectar_lecturas(*hijo, leidas);
+}
+
+// fuente_entrada de los hilos del lote. Las tablas se comparten entre los hilos:
+// aqui solo se leen. Un registro sin la columna se detiene solo.
+static void leer_de_registro(const std::string& var, std::string& linea) {
+    const std::map<std::string, std::vector<size_t>>& tabla = columnas_de;
+    auto cols = tabla.find(var);
+    size_t& k = lecturas[var];
+    if (cols == tabla.end() || k >= cols->second.size())
+        error_ejecucion("el registro " + std::to_string(fila_actual + 1) + " no tiene mas columnas '" + var +
+                        "' para lee_la_wa");
+    linea = columnas[cols->second[k++]][fila_actual];
+}
+
+struct Tanda {
+    std::vector<std::string> salidas;     // una por registro
+    std::vector<std::string> detenciones; // JSON del registro, o vacio si termino
+    bool lista = false;
+};
+
+struct Reparto {
+    std::vector<Tanda> tandas;
+    std::atomic<size_t> siguiente{0};
+    std::mutex mutex;
+    std::condition_variable terminada;
+};
+
+static void trabajar(AST* tree, const ProgramaIR* ir, const LimitesEjecucion& limites, Reparto& reparto) {
+    std::ostringstream salida;
+    salida_programa = &salida;
+    fuente_entrada = leer_de_registro;
+
+    size_t t;
+    while ((t = reparto.siguiente++) < reparto.tandas.size()) {
+        size_t inicio = t * LOTE_TANDA;
+        size_t fin = std::min(filas, inicio + LOTE_TANDA);
+        std::vector<std::string> salidas(fin - inicio);
+        std::vector<std::string> detenciones(fin - inicio);
+        for (size_t f = inicio; f < fin; ++f) {
+            reiniciar_interprete();
+            lecturas.clear();
+            fila_actual = f;
+            salida.str("");
+            ResultadoEjecucion resultado = ejecutar_con_limites(tree, ir, limites, nullptr, 0, true);
+            salidas[f - inicio] = salida.str();
+            if (resultado.estado != EJECUCION_TERMINADA)
+                detenciones[f - inicio] = resultado_json(resultado, "\"registro\": " + std::to_string(f + 1) + ", ");
+        }
+        {
+            std::lock_guard<std::mutex> lock(reparto.mutex);
+            reparto.tandas[t].salidas = std::move(salidas);
+            reparto.tandas[t].detenciones = std::move(detenciones);
+            reparto.tandas[t].lista = true;
+        }
+        reparto.terminada.notify_all();
+    }
+}
+
+bool ejecutar_lote(const char* archivo, int hilos, AST* tree, const ProgramaIR* ir,
+                   const LimitesEjecucion& limites) {
+    if (!cargar_registros(archivo)) return false;
+
+    std::set<std::string> leidas;
+    recolectar_lecturas(tree, leidas);
+    for (const std::string& var : leidas) {
+        if (!columnas_de.count(var)) {
+            std::cerr << "Error: " << archivo << " no tiene una columna '" << var << "' para lee_la_wa\n";
+            return false;
+        }
+    }
+    for (const auto& [nombre, cols] : columnas_de)
+        if (!leidas.count(nombre))
+            std::cerr << "Aviso: la columna '" << nombre << "' no se lee con lee_la_wa\n";
+
+    size_t n_tandas = (filas + LOTE_TANDA - 1) / LOTE_TANDA;
+    if (hilos <= 0) hilos = (int)std::thread::hardware_concurrency();
+    hilos = (int)std::max<size_t>(1, std::min<size_t>(hilos, n_tandas));
+
+    auto inicio = std::chrono::steady_clock::now();
+    Reparto reparto;
+    reparto.tandas.resize(n_tandas);
+    std::vector<std::thread> trabajadores;
+    for (int i = 0; i < hilos; ++i)
+        trabajadores.emplace_back(trabajar, tree, ir, std::cref(limites), std::ref(reparto));
+
+    // las tandas se escriben en orden a medida que terminan
+    size_t detenidos = 0;
+    for (Tanda& tanda : reparto.tandas) {
+        std::vector<std::string> salidas, detenciones;
+        {
+            std::unique_lock<std::mutex> lock(reparto.mutex);
+            reparto.terminada.wait(lock, [&] { return tanda.lista; });
+            salidas = std::move(tanda.salidas);
+            detenciones = std::move(tanda.detenciones);
+        }
+        for (const std::string& s : salidas)
+            std::cout.write(s.data(), s.size());
+        for (const std::string& d : detenciones) {
+            if (d.empty()) continue;
+            std::cerr << d << "\n";
+            detenidos++;
+        }
+    }
+    for (std::thread& t : trabajadores) t.join();
+    std::cout.flush();
+
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    std::cerr << "Lote: " << filas << " registros en " << segundos << " s, "
+              << (segundos > 0 ? (long long)(filas / segundos) : 0) << " registros/s (" << hilos
+              << (hilos == 1 ? " hilo" : " hilos") << ")";
+    if (detenidos > 0) std::cerr << ", " << detenidos << " detenidos por un limite o un error";
+    std::cerr << "\n";
+    return true;
+}
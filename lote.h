@@ -0,0 +1,26 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+#include "ast.h"
+#include "ir.h"
+#include "presupuesto.h"
+
+// Ejecucion por lotes (--lote). El programa se parsea y optimiza una vez y se
+// ejecuta una vez por registro de un CSV. La primera fila del archivo nombra
+// las columnas con variables del programa: el lee_la_wa de x toma el valor de
+// la columna x del registro. Si x se lee varias veces, cada columna x repetida
+// se usa en orden.
+// Los registros se reparten en tandas entre los hilos; la salida de cada
+// registro se junta aparte y se escribe en el orden del archivo. Al final se
+// informa en stderr cuantos registros por segundo se procesaron.
+// Con ir != nullptr se ejecuta la IR en vez del arbol. Cada registro tiene sus
+// propios limites; uno que se pasa o que tiene un error (tambien leer una
+// columna que no tiene) se detiene, se informa en stderr como JSON y el lote
+// sigue con los demas.
+bool ejecutar_lote(const char* archivo, int hilos, AST* tree, const ProgramaIR* ir,
+                   const LimitesEjecucion& limites);
+
+// Registros que toma cada hilo de una vez
+const int LOTE_TANDA = 64;
+
+#endif
@@ -0,0 +1,332 @@
+#include "memoria.h"
+#include "segun.h"
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+bool memoria_activa = false;
+
+struct Fase {
+    std::string nombre;
+    long rss_inicio_kb;
+    long rss_fin_kb;
+    long pico_kb;
+    bool pico_de_fase; // false si el pico es el de todo el proceso
+};
+
+struct ConteoTipo {
+    size_t nodos = 0;
+    size_t bytes = 0;
+};
+
+struct ConteoArbol {
+    std::string etiqueta;
+    std::map<std::string, ConteoTipo> por_tipo;
+    size_t nodos = 0;
+    size_t bytes = 0;
+    size_t bytes_strings = 0;
+    size_t bytes_strings_unicos = 0;
+};
+
+static std::vector<Fase> fases;
+static std::vector<ConteoArbol> arboles;
+
+static size_t pico_bytes_variables = 0;
+static size_t bytes_marcos = 0;
+static size_t pico_bytes_marcos = 0;
+static size_t profundidad = 0;
+static size_t profundidad_maxima = 0;
+static size_t llamadas = 0;
+
+// RSS actual en KB (0 si no se puede leer en esta plataforma)
+static long rss_actual_kb() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    long total = 0, residente = 0;
+    if (statm >> total >> residente) return residente * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+    return 0;
+}
+
+// Reinicia el pico de RSS (VmHWM) al RSS actual; false si no se puede
+static bool reiniciar_pico() {
+#if defined(__linux__)
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    return static_cast<bool>(clear_refs << "5" << std::flush);
+#else
+    return false;
+#endif
+}
+
+// Pico de RSS desde el ultimo reinicio, en KB (0 si no se puede leer)
+static long rss_pico_fase_kb() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string linea;
+    while (std::getline(status, linea)) {
+        if (linea.compare(0, 6, "VmHWM:") == 0) return std::stol(linea.substr(6));
+    }
+#endif
+    return 0;
+}
+
+// Pico de RSS del proceso en KB
+static long rss_pico_kb() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage uso;
+    if (getrusage(RUSAGE_SELF, &uso) == 0) {
+#if defined(__APPLE__)
+        return uso.ru_maxrss / 1024; // macOS lo entrega en bytes
+#else
+        return uso.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+void memoria_inicio_fase(const char* nombre) {
+    if (!memoria_activa) return;
+    bool reiniciado = reiniciar_pico();
+    fases.push_back(Fase{nombre, rss_actual_kb(), 0, 0, reiniciado});
+}
+
+void memoria_fin_fase() {
+    if (!memoria_activa || fases.empty()) return;
+    fases.back().rss_fin_kb = rss_actual_kb();
+    long pico = fases.back().pico_de_fase ? rss_pico_fase_kb() : 0;
+    if (pico == 0) {
+        fases.back().pico_de_fase = false;
+        pico = rss_pico_kb();
+    }
+    fases.back().pico_kb = pico;
+}
+
+static const char* nombre_nodo(NodeType tipo) {
+    switch (tipo) {
+        case NODE_INT: return "NODE_INT";
+        case NODE_FLOAT: return "NODE_FLOAT";
+        case NODE_STRING: return "NODE_STRING";
+        case NODE_ID: return "NODE_ID";
+        case NODE_ASSIGN: return "NODE_ASSIGN";
+        case NODE_PRINT: return "NODE_PRINT";
+        case NODE_BINOP: return "NODE_BINOP";
+        case NODE_IF: return "NODE_IF";
+        case NODE_WHILE: return "NODE_WHILE";
+        case NODE_FOR: return "NODE_FOR";
+        case NODE_SEQ: return "NODE_SEQ";
+        case NODE_FUNC_DEF: return "NODE_FUNC_DEF";
+        case NODE_FUNC_CALL: return "NODE_FUNC_CALL";
+        case NODE_ARGS: return "NODE_ARGS";
+        case NODE_PARAMS: return "NODE_PARAMS";
+        case NODE_RETURN: return "NODE_RETURN";
+        case NODE_DECL: return "NODE_DECL";
+        case NODE_INPUT: return "NODE_INPUT";
+        case NODE_CONCAT: return "NODE_CONCAT";
+        case NODE_LIST: return "NODE_LIST";
+        case NODE_INDEX: return "NODE_INDEX";
+        case NODE_INDEX_ASSIGN: return "NODE_INDEX_ASSIGN";
+        case NODE_SWITCH: return "NODE_SWITCH";
+        case NODE_FOTO: return "NODE_FOTO";
+        default: return "NODE_DESCONOCIDO";
+    }
+}
+
+// Bytes en el heap de un std::string (0 si cabe en el buffer interno)
+static size_t bytes_heap(const std::string& s) {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+struct Recorrido {
+    ConteoArbol* conteo;
+    std::map<std::string, size_t> strings; // contenido -> apariciones
+};
+
+static size_t contar_cadena(Recorrido& r, const char* s) {
+    if (!s) return 0;
+    size_t bytes = strlen(s) + 1;
+    r.conteo->bytes_strings += bytes;
+    if (r.strings[s]++ == 0) r.conteo->bytes_strings_unicos += bytes;
+    return bytes;
+}
+
+static void contar_nodo(Recorrido& r, AST* tree);
+
+static size_t contar_lista_nodos(Recorrido& r, std::vector<AST*>* nodos) {
+    if (!nodos) return 0;
+    for (AST* n : *nodos) contar_nodo(r, n);
+    return sizeof(std::vector<AST*>) + nodos->capacity() * sizeof(AST*);
+}
+
+static void contar_nodo(Recorrido& r, AST* tree) {
+    if (!tree) return;
+
+    size_t bytes = sizeof(AST);
+    switch (tree->type) {
+        case NODE_ID: bytes += contar_cadena(r, tree->data.id); break;
+        case NODE_STRING: bytes += contar_cadena(r, tree->data.strval); break;
+        case NODE_DECL:
+            bytes += contar_cadena(r, tree->data.decl.tipo);
+            bytes += contar_cadena(r, tree->data.decl.nombre);
+            break;
+        case NODE_ASSIGN:
+        case NODE_BINOP:
+        case NODE_PRINT:
+            contar_nodo(r, tree->data.bin.left);
+            if (tree->type != NODE_PRINT) contar_nodo(r, tree->data.bin.right);
+            break;
+        case NODE_IF:
+        case NODE_WHILE:
+            contar_nodo(r, tree->data.ctrl.cond);
+            contar_nodo(r, tree->data.ctrl.then_branch);
+            contar_nodo(r, tree->data.ctrl.else_branch);
+            break;
+        case NODE_FOR:
+            contar_nodo(r, tree->data.for_loop.init);
+            contar_nodo(r, tree->data.for_loop.cond);
+            contar_nodo(r, tree->data.for_loop.update);
+            contar_nodo(r, tree->data.for_loop.body);
+            break;
+        case NODE_SEQ:
+            contar_nodo(r, tree->data.seq.first);
+            contar_nodo(r, tree->data.seq.second);
+            break;
+        case NODE_FUNC_DEF:
+            bytes += contar_cadena(r, tree->data.func_def.name);
+            contar_nodo(r, tree->data.func_def.params);
+            contar_nodo(r, tree->data.func_def.body);
+            break;
+        case NODE_FUNC_CALL:
+            bytes += contar_cadena(r, tree->data.func_call.name);
+            contar_nodo(r, tree->data.func_call.args);
+            break;
+        case NODE_ARGS: bytes += contar_lista_nodos(r, tree->data.args.values); break;
+        case NODE_CONCAT: bytes += contar_lista_nodos(r, tree->data.concat.partes); break;
+        case NODE_LIST: bytes += contar_lista_nodos(r, tree->data.lista.elementos); break;
+        case NODE_PARAMS:
+            if (tree->data.params.names) {
+                bytes += sizeof(std::vector<std::string>) +
+                         tree->data.params.names->capacity() * sizeof(std::string);
+                for (const std::string& nombre : *(tree->data.params.names)) {
+                    bytes += bytes_heap(nombre);
+                    contar_cadena(r, nombre.c_str());
+                }
+            }
+            break;
+        case NODE_RETURN: contar_nodo(r, tree->data.ret.expr); break;
+        case NODE_INPUT: contar_nodo(r, tree->data.input.variable); break;
+        case NODE_INDEX:
+        case NODE_INDEX_ASSIGN:
+            contar_nodo(r, tree->data.index.lista);
+            contar_nodo(r, tree->data.index.indice);
+            contar_nodo(r, tree->data.index.valor);
+            break;
+        case NODE_SWITCH: {
+            const TablaSegun* tabla = tree->data.segun.tabla;
+            contar_nodo(r, tree->data.segun.expr);
+            bytes += contar_lista_nodos(r, tree->data.segun.claves);
+            bytes += contar_lista_nodos(r, tree->data.segun.cuerpos);
+            contar_nodo(r, tree->data.segun.defecto);
+            bytes += sizeof(TablaSegun) + tabla->densa.capacity() * sizeof(int) +
+                     tabla->enteros.capacity() * sizeof(tabla->enteros[0]) +
+                     tabla->textos.capacity() * sizeof(tabla->textos[0]);
+            for (const auto& [clave, caso] : tabla->textos) bytes += bytes_heap(clave);
+            break;
+        }
+        default:
+            break;
+    }
+
+    ConteoTipo& tipo = r.conteo->por_tipo[nombre_nodo(tree->type)];
+    tipo.nodos++;
+    tipo.bytes += bytes;
+    r.conteo->nodos++;
+    r.conteo->bytes += bytes;
+}
+
+void memoria_contar_arbol(const char* etiqueta, AST* tree) {
+    if (!memoria_activa) return;
+    arboles.push_back(ConteoArbol());
+    arboles.back().etiqueta = etiqueta;
+    Recorrido r;
+    r.conteo = &arboles.back();
+    contar_nodo(r, tree);
+}
+
+void memoria_variables(size_t bytes) {
+    if (bytes > pico_bytes_variables) pico_bytes_variables = bytes;
+}
+
+void memoria_entrar_llamada(size_t bytes_marco) {
+    llamadas++;
+    profundidad++;
+    if (profundidad > profundidad_maxima) profundidad_maxima = profundidad;
+    bytes_marcos += bytes_marco;
+    if (bytes_marcos > pico_bytes_marcos) pico_bytes_marcos = bytes_marcos;
+}
+
+void memoria_salir_llamada(size_t bytes_marco) {
+    profundidad--;
+    bytes_marcos -= bytes_marco;
+}
+
+static void reporte_texto(std::ostream& out) {
+    out << "--- Memoria ---\n";
+    out << "Fases (KB):\n";
+    for (const Fase& f : fases) {
+        out << "  " << f.nombre << ": rss inicio " << f.rss_inicio_kb << ", rss fin " << f.rss_fin_kb
+            << ", pico " << f.pico_kb << (f.pico_de_fase ? "" : " (del proceso)") << "\n";
+    }
+    for (const ConteoArbol& a : arboles) {
+        out << "Arbol (" << a.etiqueta << "): " << a.nodos << " nodos, " << a.bytes << " bytes\n";
+        for (const auto& [tipo, conteo] : a.por_tipo)
+            out << "  " << tipo << ": " << conteo.nodos << " nodos, " << conteo.bytes << " bytes\n";
+        out << "  strings: " << a.bytes_strings << " bytes, " << a.bytes_strings_unicos << " unicos, "
+            << (a.bytes_strings - a.bytes_strings_unicos) << " duplicados\n";
+    }
+    out << "Interprete:\n";
+    out << "  pico variables: " << pico_bytes_variables << " bytes\n";
+    out << "  pico marcos de llamada: " << pico_bytes_marcos << " bytes\n";
+    out << "  llamadas: " << llamadas << ", profundidad maxima: " << profundidad_maxima << "\n";
+}
+
+static void reporte_json(std::ostream& out) {
+    out << "{\n  \"fases\": [";
+    for (size_t i = 0; i < fases.size(); ++i) {
+        const Fase& f = fases[i];
+        out << (i ? ", " : "") << "{\"nombre\": \"" << f.nombre << "\", \"rss_inicio_kb\": " << f.rss_inicio_kb
+            << ", \"rss_fin_kb\": " << f.rss_fin_kb << ", \"pico_kb\": " << f.pico_kb
+            << ", \"pico_de_fase\": " << (f.pico_de_fase ? "true" : "false") << "}";
+    }
+    out << "],\n  \"arboles\": [";
+    for (size_t i = 0; i < arboles.size(); ++i) {
+        const ConteoArbol& a = arboles[i];
+        out << (i ? ", " : "") << "{\"etiqueta\": \"" << a.etiqueta << "\", \"nodos\": " << a.nodos
+            << ", \"bytes\": " << a.bytes << ", \"bytes_strings\": " << a.bytes_strings
+            << ", \"bytes_strings_unicos\": " << a.bytes_strings_unicos
+            << ", \"bytes_strings_duplicados\": " << (a.bytes_strings - a.bytes_strings_unicos)
+            << ", \"por_tipo\": {";
+        bool primero = true;
+        for (const auto& [tipo, conteo] : a.por_tipo) {
+            out << (primero ? "" : ", ") << "\"" << tipo << "\": {\"nodos\": " << conteo.nodos
+                << ", \"bytes\": " << conteo.bytes << "}";
+            primero = false;
+        }
+        out << "}}";
+    }
+    out << "],\n  \"interprete\": {\"pico_bytes_variables\": " << pico_bytes_variables
+        << ", \"pico_bytes_marcos\": " << pico_bytes_marcos << ", \"llamadas\": " << llamadas
+        << ", \"profundidad_maxima\": " << profundidad_maxima << "}\n}\n";
+}
+
+void memoria_reporte(std::ostream& out, bool json) {
+    if (json) reporte_json(out);
+    else reporte_texto(out);
+}
@@ -0,0 +1,27 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <cstddef>
+#include <ostream>
+#include "ast.h"
+
+// Contabilidad de memoria del compilador (--mem-stats). Con la opcion apagada
+// los puntos de medicion solo revisan esta variable.
+extern bool memoria_activa;
+
+// Fases del compilador: se guarda el RSS al empezar y al terminar, y el pico de la
+// fase (en Linux se reinicia VmHWM al empezar; si no se puede, es el del proceso)
+void memoria_inicio_fase(const char* nombre);
+void memoria_fin_fase();
+
+// Cuenta nodos, bytes por NodeType y strings del arbol
+void memoria_contar_arbol(const char* etiqueta, AST* tree);
+
+// Memoria del interprete: bytes de la tabla de variables y de los marcos de llamada
+void memoria_variables(size_t bytes);
+void memoria_entrar_llamada(size_t bytes_marco);
+void memoria_salir_llamada(size_t bytes_marco);
+
+void memoria_reporte(std::ostream& out, bool json);
+
+#endif
@@ -0,0 +1,178 @@
+#include "ast.h"
+#include "intrinsecas.h"
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// Funciones definidas con hace_la_pega en todo el programa
+static std::set<std::string> funciones_definidas;
+
+static void recolectar_funciones(AST* tree) {
+    if (!tree) return;
+    switch (tree->type) {
+        case NODE_SEQ:
+            recolectar_funciones(tree->data.seq.first);
+            recolectar_funciones(tree->data.seq.second);
+            break;
+        case NODE_IF:
+        case NODE_WHILE:
+            recolectar_funciones(tree->data.ctrl.then_branch);
+            recolectar_funciones(tree->data.ctrl.else_branch);
+            break;
+        case NODE_FOR:
+            recolectar_funciones(tree->data.for_loop.body);
+            break;
+        case NODE_SWITCH:
+            for (AST* cuerpo : *(tree->data.segun.cuerpos))
+                recolectar_funciones(cuerpo);
+            recolectar_funciones(tree->data.segun.defecto);
+            break;
+        case NODE_FUNC_DEF:
+            funciones_definidas.insert(tree->data.func_def.name);
+            recolectar_funciones(tree->data.func_def.body);
+            break;
+        default:
+            break;
+    }
+}
+
+// Las llamadas a intrinsecas quedan resueltas para que el interprete no las
+// busque en cada llamada. Una funcion del usuario con el mismo nombre tiene prioridad.
+static void resolver_llamada(AST* tree) {
+    std::string nombre = tree->data.func_call.name;
+    if (funciones_definidas.count(nombre)) return;
+
+    const Intrinseca* in = buscar_intrinseca(nombre);
+    if (!in) {
+        std::cerr << "Error: funcion '" << nombre << "' no definida.\n";
+        exit(1);
+    }
+    size_t n = (tree->data.func_call.args && tree->data.func_call.args->data.args.values)
+                   ? tree->data.func_call.args->data.args.values->size() : 0;
+    if (n < in->min_args || n > in->max_args) {
+        std::cerr << "Error: cantidad de argumentos invalida para '" << nombre << "'\n";
+        exit(1);
+    }
+    tree->data.func_call.intrinseca = in;
+}
+
+// Indica si la expresion siempre produce un string, sin tener que evaluarla
+static bool es_texto(AST* expr) {
+    return expr && (expr->type == NODE_STRING || expr->type == NODE_CONCAT);
+}
+
+// Agrega 'expr' a las partes, aplanando concatenaciones ya construidas y
+// juntando literales seguidos en uno solo
+static void agregar_parte(std::vector<AST*>* partes, AST* expr) {
+    if (expr->type == NODE_CONCAT) {
+        for (AST* parte : *(expr->data.concat.partes))
+            agregar_parte(partes, parte);
+        return;
+    }
+    if (expr->type == NODE_STRING && !partes->empty() && partes->back()->type == NODE_STRING) {
+        std::string junto = std::string(partes->back()->data.strval) + expr->data.strval;
+        partes->back() = make_string(junto.c_str());
+        return;
+    }
+    partes->push_back(expr);
+}
+
+// Una suma donde algun lado es string se convierte en concatenacion. Como los
+// hijos ya se optimizaron, una cadena "a" + b + c + "d" termina en un solo CONCAT.
+// Las sumas numericas dentro de la cadena (sin strings) quedan como una parte.
+static AST* optimizar_suma(AST* tree) {
+    AST* lhs = tree->data.bin.left;
+    AST* rhs = tree->data.bin.right;
+    if (!es_texto(lhs) && !es_texto(rhs)) return tree;
+
+    std::vector<AST*>* partes = new std::vector<AST*>();
+    agregar_parte(partes, lhs);
+    agregar_parte(partes, rhs);
+    if (partes->size() == 1) {
+        AST* unica = partes->front();
+        delete partes;
+        return unica;
+    }
+    return make_concat(partes);
+}
+
+static AST* optimizar_nodo(AST* tree) {
+    if (!tree) return nullptr;
+
+    switch (tree->type) {
+        case NODE_ASSIGN:
+            tree->data.bin.right = optimizar_nodo(tree->data.bin.right);
+            break;
+        case NODE_PRINT:
+            tree->data.bin.left = optimizar_nodo(tree->data.bin.left);
+            break;
+        case NODE_BINOP:
+            tree->data.bin.left = optimizar_nodo(tree->data.bin.left);
+            tree->data.bin.right = optimizar_nodo(tree->data.bin.right);
+            if (tree->op == OP_PLUS) return optimizar_suma(tree);
+            break;
+        case NODE_IF:
+        case NODE_WHILE:
+            tree->data.ctrl.cond = optimizar_nodo(tree->data.ctrl.cond);
+            tree->data.ctrl.then_branch = optimizar_nodo(tree->data.ctrl.then_branch);
+            tree->data.ctrl.else_branch = optimizar_nodo(tree->data.ctrl.else_branch);
+            break;
+        case NODE_FOR:
+            tree->data.for_loop.init = optimizar_nodo(tree->data.for_loop.init);
+            tree->data.for_loop.cond = optimizar_nodo(tree->data.for_loop.cond);
+            tree->data.for_loop.update = optimizar_nodo(tree->data.for_loop.update);
+            tree->data.for_loop.body = optimizar_nodo(tree->data.for_loop.body);
+            break;
+        case NODE_SWITCH:
+            tree->data.segun.expr = optimizar_nodo(tree->data.segun.expr);
+            for (AST*& cuerpo : *(tree->data.segun.cuerpos))
+                cuerpo = optimizar_nodo(cuerpo);
+            tree->data.segun.defecto = optimizar_nodo(tree->data.segun.defecto);
+            break;
+        case NODE_SEQ:
+            tree->data.seq.first = optimizar_nodo(tree->data.seq.first);
+            tree->data.seq.second = optimizar_nodo(tree->data.seq.second);
+            break;
+        case NODE_FUNC_DEF:
+            tree->data.func_def.body = optimizar_nodo(tree->data.func_def.body);
+            break;
+        case NODE_FUNC_CALL:
+            optimizar_nodo(tree->data.func_call.args);
+            resolver_llamada(tree);
+            break;
+        case NODE_ARGS:
+            if (tree->data.args.values) {
+                for (AST*& arg : *(tree->data.args.values))
+                    arg = optimizar_nodo(arg);
+            }
+            break;
+        case NODE_RETURN:
+            tree->data.ret.expr = optimizar_nodo(tree->data.ret.expr);
+            break;
+        case NODE_CONCAT:
+            for (AST*& parte : *(tree->data.concat.partes))
+                parte = optimizar_nodo(parte);
+            break;
+        case NODE_LIST:
+            for (AST*& elem : *(tree->data.lista.elementos))
+                elem = optimizar_nodo(elem);
+            break;
+        case NODE_INDEX:
+        case NODE_INDEX_ASSIGN:
+            tree->data.index.indice = optimizar_nodo(tree->data.index.indice);
+            tree->data.index.valor = optimizar_nodo(tree->data.index.valor);
+            break;
+        default:
+            break;
+    }
+    return tree;
+}
+
+AST* optimizar_ast(AST* tree) {
+    funciones_definidas.clear();
+    recolectar_funciones(tree);
+    tree = optimizar_nodo(tree);
+    tree = optimizar_segun(tree);
+    return optimizar_llamadas(tree);
+}
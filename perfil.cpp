@@ -0,0 +1,107 @@
+#include "perfil.h"
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <sys/time.h>
+#define CHL_PERFIL_SOPORTADO 1
+#endif
+
+bool perfil_activo = false;
+
+// Nodo del arbol de contextos de llamada: una pila completa desde "principal"
+struct NodoPerfil {
+    const char* funcion;
+    NodoPerfil* padre;
+    std::vector<NodoPerfil*> hijos;
+    volatile long muestras = 0;
+
+    NodoPerfil(const char* f, NodoPerfil* p) : funcion(f), padre(p) {}
+};
+
+// deque: agregar nodos no mueve los existentes, asi el manejador de la senal
+// puede usar el puntero al nodo actual mientras el interprete crea otros
+static std::deque<NodoPerfil> nodos;
+static NodoPerfil* volatile nodo_actual = nullptr;
+
+#ifdef CHL_PERFIL_SOPORTADO
+static void tomar_muestra(int) {
+    NodoPerfil* nodo = nodo_actual;
+    if (nodo) nodo->muestras = nodo->muestras + 1;
+}
+#endif
+
+bool perfil_iniciar(long intervalo_us) {
+#ifdef CHL_PERFIL_SOPORTADO
+    nodos.emplace_back("principal", nullptr);
+    nodo_actual = &nodos.back();
+
+    struct sigaction accion;
+    memset(&accion, 0, sizeof(accion));
+    accion.sa_handler = tomar_muestra;
+    accion.sa_flags = SA_RESTART;
+    sigemptyset(&accion.sa_mask);
+    if (sigaction(SIGPROF, &accion, nullptr) != 0) return false;
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = intervalo_us / 1000000;
+    timer.it_interval.tv_usec = intervalo_us % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) return false;
+
+    perfil_activo = true;
+    return true;
+#else
+    (void)intervalo_us;
+    std::cerr << "Error: --perfil no esta soportado en esta plataforma\n";
+    return false;
+#endif
+}
+
+void perfil_entrar(const char* funcion) {
+    NodoPerfil* padre = nodo_actual;
+    for (NodoPerfil* hijo : padre->hijos) {
+        if (strcmp(hijo->funcion, funcion) == 0) {
+            nodo_actual = hijo;
+            return;
+        }
+    }
+    nodos.emplace_back(funcion, padre);
+    padre->hijos.push_back(&nodos.back());
+    nodo_actual = &nodos.back();
+}
+
+void perfil_salir() {
+    nodo_actual = nodo_actual->padre;
+}
+
+static void escribir_nodo(std::ostream& out, const NodoPerfil* nodo, const std::string& prefijo) {
+    std::string pila = prefijo.empty() ? nodo->funcion : prefijo + ";" + nodo->funcion;
+    if (nodo->muestras > 0) out << pila << " " << nodo->muestras << "\n";
+    for (const NodoPerfil* hijo : nodo->hijos)
+        escribir_nodo(out, hijo, pila);
+}
+
+bool perfil_escribir(const char* archivo) {
+#ifdef CHL_PERFIL_SOPORTADO
+    struct itimerval apagado;
+    memset(&apagado, 0, sizeof(apagado));
+    setitimer(ITIMER_PROF, &apagado, nullptr);
+    signal(SIGPROF, SIG_IGN);
+#endif
+    perfil_activo = false;
+    if (nodos.empty()) return false;
+
+    std::ofstream out(archivo);
+    if (!out) {
+        std::cerr << "No se pudo escribir el perfil: " << archivo << std::endl;
+        return false;
+    }
+    escribir_nodo(out, &nodos.front(), "");
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+// Profiler por muestreo de funciones Chileno (--perfil). El interprete mantiene
+// una pila sombra de llamadas a hace_la_pega y un timer (SIGPROF) cuenta en que
+// pila estaba el programa. La salida es "folded stacks" para flamegraph.pl,
+// speedscope, inferno, etc. Con la opcion apagada solo se revisa esta variable.
+extern bool perfil_activo;
+
+// Intervalo por defecto entre muestras, en microsegundos de CPU
+const long PERFIL_INTERVALO_US = 1000;
+
+bool perfil_iniciar(long intervalo_us);
+void perfil_entrar(const char* funcion);
+void perfil_salir();
+
+// Detiene el muestreo y escribe una linea "principal;f;g <muestras>" por pila
+bool perfil_escribir(const char* archivo);
+
+#endif
@@ -0,0 +1,138 @@
+#include "pgo.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+bool pgo_grabando = false;
+
+// Un si_po, un ciclo o una llamada. En los si_po y ciclos 'cumple' y 'no_cumple'
+// cuentan las evaluaciones de la condicion (en un ciclo, vueltas y salidas);
+// en las llamadas 'cumple' es la cantidad de llamadas.
+struct SitioPgo {
+    std::string tipo; // "si", "ciclo" o "llamada"
+    std::string funcion;
+    long long cumple = 0;
+    long long no_cumple = 0;
+};
+
+static std::vector<SitioPgo> sitios;
+static bool cargado = false;
+static long long total_llamadas = 0;
+
+static void numerar(AST* tree) {
+    if (!tree) return;
+    const char* tipo = nullptr;
+    switch (tree->type) {
+        case NODE_IF: tipo = "si"; break;
+        case NODE_WHILE:
+        case NODE_FOR: tipo = "ciclo"; break;
+        case NODE_FUNC_CALL: tipo = "llamada"; break;
+        default: break;
+    }
+    if (tipo) {
+        tree->sitio = (int)sitios.size();
+        SitioPgo& s = sitios.emplace_back();
+        s.tipo = tipo;
+        if (tree->type == NODE_FUNC_CALL) s.funcion = tree->data.func_call.name;
+    }
+    for (AST** hijo : ast_hijos(tree)) numerar(*hijo);
+}
+
+void pgo_numerar(AST* tree) {
+    sitios.clear();
+    numerar(tree);
+}
+
+void pgo_rama(int sitio, bool cumple) {
+    if (sitio < 0) return;
+    if (cumple) sitios[sitio].cumple++;
+    else sitios[sitio].no_cumple++;
+}
+
+void pgo_llamada(int sitio) {
+    if (sitio >= 0) sitios[sitio].cumple++;
+}
+
+bool pgo_escribir(const char* archivo) {
+    std::ofstream out(archivo);
+    if (!out) {
+        std::cerr << "No se pudo escribir el perfil: " << archivo << std::endl;
+        return false;
+    }
+    out << "# perfil de chileno_compilador (--pgo-grabar)\n";
+    out << "sitios " << sitios.size() << "\n";
+    for (size_t i = 0; i < sitios.size(); ++i) {
+        const SitioPgo& s = sitios[i];
+        out << s.tipo << " " << i << " " << s.cumple;
+        if (s.tipo == "llamada") out << " " << s.funcion << "\n";
+        else out << " " << s.no_cumple << "\n";
+    }
+    return true;
+}
+
+bool pgo_cargar(const char* archivo) {
+    std::ifstream in(archivo);
+    if (!in) {
+        std::cerr << "No se pudo abrir el perfil: " << archivo << std::endl;
+        return false;
+    }
+
+    std::vector<SitioPgo> leidos = sitios;
+    std::string linea, palabra;
+    size_t cantidad = 0;
+    bool valido = true;
+    while (valido && std::getline(in, linea)) {
+        if (linea.empty() || linea[0] == '#') continue;
+        std::istringstream campos(linea);
+        campos >> palabra;
+        if (palabra == "sitios") {
+            valido = (campos >> cantidad) && cantidad == sitios.size();
+            continue;
+        }
+        size_t i;
+        SitioPgo s;
+        s.tipo = palabra;
+        if (!(campos >> i >> s.cumple) || i >= leidos.size() || leidos[i].tipo != s.tipo) {
+            valido = false;
+            break;
+        }
+        if (s.tipo == "llamada") valido = (campos >> s.funcion) && s.funcion == leidos[i].funcion;
+        else valido = (bool)(campos >> s.no_cumple);
+        leidos[i].cumple = s.cumple;
+        leidos[i].no_cumple = s.no_cumple;
+    }
+    if (!valido || cantidad != sitios.size()) {
+        std::cerr << "Aviso: el perfil " << archivo << " no corresponde a este programa, se ignora\n";
+        return true;
+    }
+
+    sitios = leidos;
+    total_llamadas = 0;
+    for (const SitioPgo& s : sitios)
+        if (s.tipo == "llamada") total_llamadas += s.cumple;
+    cargado = true;
+    return true;
+}
+
+bool pgo_cargado() {
+    return cargado;
+}
+
+double pgo_probabilidad(int sitio) {
+    if (!cargado || sitio < 0) return -1;
+    const SitioPgo& s = sitios[sitio];
+    long long total = s.cumple + s.no_cumple;
+    return total > 0 ? (double)s.cumple / total : -1;
+}
+
+long long pgo_veces(int sitio) {
+    if (!cargado || sitio < 0) return -1;
+    return sitios[sitio].cumple;
+}
+
+bool pgo_llamada_caliente(int sitio) {
+    long long veces = pgo_veces(sitio);
+    return veces > 0 && veces >= PGO_LLAMADA_CALIENTE * total_llamadas;
+}
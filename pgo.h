@@ -0,0 +1,39 @@
+#ifndef PGO_H
+#define PGO_H
+
+#include "ast.h"
+
+// Optimizacion guiada por perfil. Con --pgo-grabar el interprete cuenta cuantas
+// veces se cumple cada si_po y cada condicion de ciclo, y cuantas veces se hace
+// cada llamada. Con --pgo-usar una compilacion posterior lee esos conteos para
+// hacer inline de las llamadas calientes, marcar las ramas probables con
+// [[likely]] en el C++ y ordenar los bloques de la IR.
+// Los sitios se numeran en el arbol del parser, antes de optimizar, asi el mismo
+// programa tiene los mismos numeros en cada compilacion.
+extern bool pgo_grabando;
+
+// Numera los si_po, ciclos y llamadas del arbol (AST::sitio)
+void pgo_numerar(AST* tree);
+
+void pgo_rama(int sitio, bool cumple);
+void pgo_llamada(int sitio);
+
+bool pgo_escribir(const char* archivo);
+// Devuelve false si no se pudo leer; un perfil de otro programa se ignora con un aviso
+bool pgo_cargar(const char* archivo);
+
+// Fraccion de las veces que se cumplio la condicion, o -1 si no hay datos
+double pgo_probabilidad(int sitio);
+// Veces que se hizo la llamada, o -1 si no hay datos
+long long pgo_veces(int sitio);
+bool pgo_llamada_caliente(int sitio);
+bool pgo_cargado();
+
+// Desde esta probabilidad una rama es probable (y bajo 1 - esto, improbable)
+const double PGO_RAMA_PROBABLE = 0.8;
+// Fraccion del total de llamadas desde la que una llamada es caliente
+const double PGO_LLAMADA_CALIENTE = 0.01;
+// Las llamadas calientes aceptan funciones este factor mas grandes para el inline
+const int PGO_FACTOR_INLINE = 4;
+
+#endif
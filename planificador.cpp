@@ -0,0 +1,106 @@
+#include "planificador.h"
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+struct Contexto {
+    const ProgramaPlanificado* programa;
+    std::ostringstream salida;
+    ResultadoEjecucion resultado;
+    std::condition_variable despertar;
+    bool con_turno = false;
+};
+
+// Turnos libres y contextos esperando uno, en orden de llegada
+static std::mutex mutex_turnos;
+static std::deque<Contexto*> en_espera;
+static int turnos_libres = 0;
+
+static void pedir_turno(Contexto& c) {
+    std::unique_lock<std::mutex> lock(mutex_turnos);
+    if (turnos_libres > 0 && en_espera.empty()) {
+        turnos_libres--;
+        return;
+    }
+    en_espera.push_back(&c);
+    c.despertar.wait(lock, [&] { return c.con_turno; });
+    c.con_turno = false;
+}
+
+// El turno pasa directo al primero que espera
+static void soltar_turno() {
+    std::lock_guard<std::mutex> lock(mutex_turnos);
+    if (en_espera.empty()) {
+        turnos_libres++;
+        return;
+    }
+    Contexto* siguiente = en_espera.front();
+    en_espera.pop_front();
+    siguiente->con_turno = true;
+    siguiente->despertar.notify_one();
+}
+
+// Entrada estandar compartida: se lee a medida que algun contexto la pide
+static std::mutex mutex_entrada;
+static std::vector<std::string> lineas_entrada;
+static bool entrada_terminada = false;
+static thread_local size_t linea_actual = 0;
+
+static void leer_entrada_compartida(const std::string&, std::string& linea) {
+    std::lock_guard<std::mutex> lock(mutex_entrada);
+    while (lineas_entrada.size() <= linea_actual && !entrada_terminada) {
+        std::string leida;
+        if (std::getline(std::cin, leida))
+            lineas_entrada.push_back(leida);
+        else
+            entrada_terminada = true;
+    }
+    linea = linea_actual < lineas_entrada.size() ? lineas_entrada[linea_actual] : "";
+    linea_actual++;
+}
+
+// Cada programa escribe su salida y su resultado apenas termina
+static std::mutex mutex_salida;
+static int detenidos = 0;
+
+static void informar(Contexto& c) {
+    std::lock_guard<std::mutex> lock(mutex_salida);
+    std::cout << "--- " << c.programa->nombre << " ---\n" << c.salida.str() << std::flush;
+    std::cerr << resultado_json(c.resultado, "\"programa\": \"" + c.programa->nombre + "\", ") << "\n";
+    if (c.resultado.estado != EJECUCION_TERMINADA) detenidos++;
+}
+
+static void correr(Contexto& c, long long turno, const LimitesEjecucion& limites) {
+    salida_programa = &c.salida;
+    fuente_entrada = leer_entrada_compartida;
+    linea_actual = 0;
+
+    pedir_turno(c);
+    reiniciar_interprete();
+    c.resultado = ejecutar_con_limites(c.programa->tree, c.programa->ir, limites,
+                                       [&] {
+                                           soltar_turno();
+                                           pedir_turno(c);
+                                       },
+                                       turno, true);
+    reiniciar_interprete();
+    soltar_turno();
+    informar(c);
+}
+
+int planificar(const std::vector<ProgramaPlanificado>& programas, int trabajadores, long long turno,
+               const LimitesEjecucion& limites) {
+    turnos_libres = trabajadores;
+    detenidos = 0;
+    std::deque<Contexto> contextos(programas.size());
+    std::vector<std::thread> hilos;
+    for (size_t i = 0; i < programas.size(); ++i) {
+        contextos[i].programa = &programas[i];
+        hilos.emplace_back(correr, std::ref(contextos[i]), turno, std::cref(limites));
+    }
+    for (std::thread& h : hilos) h.join();
+    return detenidos;
+}
@@ -0,0 +1,34 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+#include <string>
+#include <vector>
+#include "ast.h"
+#include "ir.h"
+#include "presupuesto.h"
+
+// Planificador de contextos (--planificar). Cada programa corre en su propio
+// contexto: variables, funciones, salida y presupuesto. A lo mas 'trabajadores'
+// contextos tienen turno a la vez; cada 'turno' pasos el que corre le pasa el
+// turno al primero que espera y se pone al final de la fila, asi un programa
+// que no termina no deja sin turno a los demas.
+// El interprete del arbol es recursivo y guarda su estado en la pila, por eso
+// cada contexto tiene su hilo; el planificador decide cuales avanzan. 'trabajadores'
+// no limita los hilos: hay uno por programa, y los que esperan turno quedan dormidos.
+// Todos los programas leen la misma entrada estandar, cada uno desde el principio.
+struct ProgramaPlanificado {
+    std::string nombre;
+    AST* tree;
+    const ProgramaIR* ir; // nullptr: se interpreta el arbol
+};
+
+// Cuando un programa termina se escribe su salida y su resultado (en stderr,
+// como JSON). Un error del programa solo detiene a ese programa. Devuelve
+// cuantos se detuvieron por un limite o un error.
+int planificar(const std::vector<ProgramaPlanificado>& programas, int trabajadores, long long turno,
+               const LimitesEjecucion& limites);
+
+// Pasos por turno si no se indica otro
+const long long PLANIFICADOR_TURNO = 10000;
+
+#endif
@@ -0,0 +1,172 @@
+#include "presupuesto.h"
+#include "listas.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+thread_local long long pasos_ejecucion = 0;
+thread_local long long proximo_control = LLONG_MAX;
+thread_local size_t bytes_marcos = 0;
+thread_local int profundidad_llamadas = 0;
+thread_local const std::vector<Value>* registros_ir = nullptr;
+thread_local size_t limite_memoria = 0;
+
+using Reloj = std::chrono::steady_clock;
+
+// Ejecucion con limites de este hilo
+struct Presupuesto {
+    LimitesEjecucion limites;
+    const std::function<void()>* ceder = nullptr;
+    long long turno = 0;
+    long long proximo_turno = LLONG_MAX;
+    Reloj::time_point inicio_turno;
+    double segundos_previos = 0; // de los turnos anteriores
+    size_t bytes_pico = 0;
+    bool aislar_errores = false;
+};
+
+static thread_local Presupuesto presupuesto;
+
+// Se lanza desde un punto de control y se atrapa en ejecutar_con_limites; al
+// desarmar la pila no queda nada del interprete que haya que cerrar
+struct DetencionEjecucion {
+    EstadoEjecucion estado;
+    std::string mensaje = {}; // solo con EJECUCION_ERROR
+};
+
+static double segundos_corridos() {
+    return presupuesto.segundos_previos +
+           std::chrono::duration<double>(Reloj::now() - presupuesto.inicio_turno).count();
+}
+
+size_t bytes_valor(const Value& v) {
+    if (v.type == Value::STRING) {
+        const std::string& s = std::get<std::string>(v.val);
+        return s.capacity() > 15 ? s.capacity() + 1 : 0;
+    }
+    if (v.type == Value::LIST)
+        return sizeof(Lista) + v.asList()->enteros.capacity() * sizeof(int) +
+               v.asList()->flotantes.capacity() * sizeof(float);
+    return 0;
+}
+
+static size_t bytes_estimados() {
+    size_t bytes = bytes_marcos + bytes_variables_interprete();
+    if (registros_ir)
+        for (const Value& v : *registros_ir) bytes += bytes_valor(v);
+    return bytes;
+}
+
+static void programar_control() {
+    long long proximo = pasos_ejecucion + PRESUPUESTO_INTERVALO;
+    if (presupuesto.limites.pasos > 0) proximo = std::min(proximo, presupuesto.limites.pasos + 1);
+    proximo_control = std::min(proximo, presupuesto.proximo_turno);
+}
+
+void controlar_presupuesto() {
+    const LimitesEjecucion& limites = presupuesto.limites;
+    if (profundidad_llamadas > PRESUPUESTO_MAX_PROFUNDIDAD) throw DetencionEjecucion{EJECUCION_LIMITE_PROFUNDIDAD};
+    if (limites.pasos > 0 && pasos_ejecucion > limites.pasos) throw DetencionEjecucion{EJECUCION_LIMITE_PASOS};
+    if (limites.segundos > 0 && segundos_corridos() > limites.segundos)
+        throw DetencionEjecucion{EJECUCION_LIMITE_TIEMPO};
+    if (limites.bytes > 0) controlar_memoria(0);
+    if (pasos_ejecucion >= presupuesto.proximo_turno) {
+        // el tiempo esperando el proximo turno no cuenta
+        presupuesto.segundos_previos = segundos_corridos();
+        (*presupuesto.ceder)();
+        presupuesto.inicio_turno = Reloj::now();
+        presupuesto.proximo_turno = pasos_ejecucion + presupuesto.turno;
+    }
+    programar_control();
+}
+
+void controlar_memoria(size_t bytes_nuevos) {
+    size_t bytes = bytes_estimados() + bytes_nuevos;
+    presupuesto.bytes_pico = std::max(presupuesto.bytes_pico, bytes);
+    if (bytes > presupuesto.limites.bytes) throw DetencionEjecucion{EJECUCION_LIMITE_MEMORIA};
+}
+
+void error_ejecucion(const std::string& mensaje) {
+    if (presupuesto.aislar_errores) throw DetencionEjecucion{EJECUCION_ERROR, mensaje};
+    std::cerr << "Error: " << mensaje << "\n";
+    exit(1);
+}
+
+ResultadoEjecucion ejecutar_con_limites(AST* tree, const ProgramaIR* ir, const LimitesEjecucion& limites,
+                                        const std::function<void()>& ceder, long long turno, bool aislar_errores) {
+    presupuesto = Presupuesto();
+    presupuesto.limites = limites;
+    presupuesto.aislar_errores = aislar_errores;
+    limite_memoria = limites.bytes;
+    if (ceder && turno > 0) {
+        presupuesto.ceder = &ceder;
+        presupuesto.turno = turno;
+        presupuesto.proximo_turno = turno;
+    }
+    pasos_ejecucion = 0;
+    bytes_marcos = 0;
+    profundidad_llamadas = 0;
+    registros_ir = nullptr;
+    presupuesto.inicio_turno = Reloj::now();
+    // sin limites ni turnos el contador nunca llega a la revision
+    if (limites.activos() || presupuesto.ceder)
+        programar_control();
+    else
+        proximo_control = LLONG_MAX;
+
+    ResultadoEjecucion resultado;
+    try {
+        if (ir)
+            ejecutar_ir(*ir);
+        else
+            eval_ast(tree);
+    } catch (const DetencionEjecucion& detencion) {
+        resultado.estado = detencion.estado;
+        resultado.mensaje = detencion.mensaje;
+    } catch (const std::bad_alloc&) {
+        // un valor que no cupo en la memoria del proceso
+        resultado.estado = EJECUCION_LIMITE_MEMORIA;
+    }
+    salida_programa->flush();
+    resultado.pasos = pasos_ejecucion;
+    resultado.segundos = segundos_corridos();
+    resultado.bytes_pico = presupuesto.bytes_pico;
+
+    proximo_control = LLONG_MAX;
+    presupuesto.ceder = nullptr;
+    presupuesto.aislar_errores = false;
+    limite_memoria = 0;
+    registros_ir = nullptr;
+    return resultado;
+}
+
+const char* nombre_estado(EstadoEjecucion estado) {
+    switch (estado) {
+        case EJECUCION_TERMINADA: return "terminada";
+        case EJECUCION_LIMITE_PASOS: return "limite_pasos";
+        case EJECUCION_LIMITE_TIEMPO: return "limite_tiempo";
+        case EJECUCION_LIMITE_MEMORIA: return "limite_memoria";
+        case EJECUCION_LIMITE_PROFUNDIDAD: return "limite_profundidad";
+        case EJECUCION_ERROR: return "error";
+    }
+    return "desconocido";
+}
+
+std::string resultado_json(const ResultadoEjecucion& r, const std::string& extra) {
+    std::ostringstream out;
+    out << "{" << extra << "\"estado\": \"" << nombre_estado(r.estado) << "\", \"pasos\": " << r.pasos
+        << ", \"segundos\": " << r.segundos << ", \"memoria_pico_bytes\": " << r.bytes_pico;
+    if (!r.mensaje.empty()) {
+        out << ", \"mensaje\": \"";
+        for (char c : r.mensaje) {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << "\"";
+    }
+    out << "}";
+    return out.str();
+}
@@ -0,0 +1,96 @@
+#ifndef PRESUPUESTO_H
+#define PRESUPUESTO_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "ast.h"
+#include "ir.h"
+
+// Presupuesto de una ejecucion. Los interpretes cuentan un paso en cada vuelta
+// de ciclo (en la IR, cada salto hacia atras) y en cada entrada a una funcion.
+// Cada PRESUPUESTO_INTERVALO pasos se revisan el tiempo y la memoria, y la
+// memoria tambien cada vez que se crea un valor grande (ver reservar_memoria);
+// si se pasa un limite la ejecucion se detiene y el resultado dice cual fue, en
+// vez de terminar el proceso.
+
+// Un limite en 0 no se revisa
+struct LimitesEjecucion {
+    long long pasos = 0;
+    double segundos = 0; // tiempo con turno, sin contar la espera en el planificador
+    size_t bytes = 0;    // estimacion de las variables y marcos del interprete
+
+    bool activos() const { return pasos > 0 || segundos > 0 || bytes > 0; }
+};
+
+enum EstadoEjecucion {
+    EJECUCION_TERMINADA,
+    EJECUCION_LIMITE_PASOS,
+    EJECUCION_LIMITE_TIEMPO,
+    EJECUCION_LIMITE_MEMORIA,
+    EJECUCION_LIMITE_PROFUNDIDAD, // llamadas anidadas, antes de que se acabe la pila
+    EJECUCION_ERROR               // error del programa con aislar_errores
+};
+
+struct ResultadoEjecucion {
+    EstadoEjecucion estado = EJECUCION_TERMINADA;
+    long long pasos = 0;
+    double segundos = 0;
+    size_t bytes_pico = 0; // solo se mide con limite de memoria
+    std::string mensaje;   // con EJECUCION_ERROR
+};
+
+// Contador del hilo y paso en que toca la proxima revision
+extern thread_local long long pasos_ejecucion;
+extern thread_local long long proximo_control;
+// Bytes y cantidad de los marcos de llamada activos; los llevan los dos interpretes
+extern thread_local size_t bytes_marcos;
+extern thread_local int profundidad_llamadas;
+// Registros de la funcion de la IR que se esta ejecutando (para la memoria)
+extern thread_local const std::vector<Value>* registros_ir;
+
+// Limite de memoria de la ejecucion de este hilo (0: sin limite)
+extern thread_local size_t limite_memoria;
+
+void controlar_presupuesto();
+void controlar_memoria(size_t bytes_nuevos);
+
+inline void contar_paso() {
+    if (++pasos_ejecucion >= proximo_control) controlar_presupuesto();
+}
+
+// Antes de crear un valor de 'bytes' bytes (un texto o una lista) o de guardarlo
+// en una variable. Con limite de memoria se revisa en el momento: un solo valor
+// puede pasar el limite entre dos puntos de control.
+inline void reservar_memoria(size_t bytes) {
+    if (limite_memoria > 0) controlar_memoria(bytes);
+}
+
+// Bytes de un texto o una lista fuera del Value
+size_t bytes_valor(const Value& v);
+
+// Ejecuta el arbol, o la IR si ir != nullptr, dentro de los limites. Si 'ceder'
+// no es nulo se llama cada 'turno' pasos, para que el planificador le pase el
+// turno a otro contexto. Con aislar_errores un error del programa solo detiene
+// esta ejecucion (ver error_ejecucion).
+ResultadoEjecucion ejecutar_con_limites(AST* tree, const ProgramaIR* ir, const LimitesEjecucion& limites,
+                                        const std::function<void()>& ceder = nullptr, long long turno = 0,
+                                        bool aislar_errores = false);
+
+// Error del programa mientras se ejecuta. Si la ejecucion aisla errores termina
+// con EJECUCION_ERROR y el mensaje en el resultado; si no, escribe
+// "Error: <mensaje>" en stderr y termina el proceso como siempre.
+[[noreturn]] void error_ejecucion(const std::string& mensaje);
+
+const char* nombre_estado(EstadoEjecucion estado);
+// Una linea JSON; 'extra' va al principio, ya formateado (p. ej. "\"registro\": 3, ")
+std::string resultado_json(const ResultadoEjecucion& r, const std::string& extra = "");
+
+// Pasos entre revisiones de tiempo y memoria
+const long long PRESUPUESTO_INTERVALO = 1024;
+// Con presupuesto no se pasa de estas llamadas anidadas: con una pila de 8 MB
+// el interprete del arbol se cae cerca de las 9000. Como cada llamada es un
+// paso, entre dos revisiones se suman a lo mas PRESUPUESTO_INTERVALO.
+const int PRESUPUESTO_MAX_PROFUNDIDAD = 4000;
+
+#endif
@@ -0,0 +1,227 @@
+#include "segun.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+// Rango maximo de claves enteras para usar el arreglo directo; ademas al menos
+// un cuarto de las posiciones tiene que tener un caso
+static const long long SEGUN_MAX_RANGO_DENSO = 4096;
+
+int TablaSegun::buscar(const Value& v) const {
+    if (v.type == Value::INT) {
+        int clave = v.asInt();
+        if (!densa.empty()) {
+            // una clave bajo el minimo da la vuelta y tambien queda fuera
+            size_t i = (size_t)((long long)clave - minimo);
+            return i < densa.size() ? densa[i] : casos;
+        }
+        auto it = std::lower_bound(enteros.begin(), enteros.end(), clave,
+                                   [](const std::pair<int, int>& e, int k) { return e.first < k; });
+        return it != enteros.end() && it->first == clave ? it->second : casos;
+    }
+    if (v.type == Value::STRING) {
+        const std::string& clave = std::get<std::string>(v.val);
+        auto it = std::lower_bound(textos.begin(), textos.end(), clave,
+                                   [](const std::pair<std::string, int>& e, const std::string& k) { return e.first < k; });
+        return it != textos.end() && it->first == clave ? it->second : casos;
+    }
+    return casos;
+}
+
+TablaSegun* armar_tabla_segun(const std::vector<AST*>& claves) {
+    TablaSegun* tabla = new TablaSegun();
+    tabla->casos = (int)claves.size();
+    for (int i = 0; i < tabla->casos; ++i) {
+        if (claves[i]->type == NODE_INT) tabla->enteros.push_back({claves[i]->data.intval, i});
+        else tabla->textos.push_back({claves[i]->data.strval, i});
+    }
+    std::sort(tabla->enteros.begin(), tabla->enteros.end());
+    std::sort(tabla->textos.begin(), tabla->textos.end());
+
+    for (size_t i = 1; i < tabla->enteros.size(); ++i) {
+        if (tabla->enteros[i].first == tabla->enteros[i - 1].first) {
+            std::cerr << "Error: caso " << tabla->enteros[i].first << " repetido en segun_la_wa\n";
+            exit(1);
+        }
+    }
+    for (size_t i = 1; i < tabla->textos.size(); ++i) {
+        if (tabla->textos[i].first == tabla->textos[i - 1].first) {
+            std::cerr << "Error: caso \"" << tabla->textos[i].first << "\" repetido en segun_la_wa\n";
+            exit(1);
+        }
+    }
+
+    if (!tabla->enteros.empty()) {
+        long long rango = (long long)tabla->enteros.back().first - tabla->enteros.front().first + 1;
+        if (rango <= SEGUN_MAX_RANGO_DENSO && rango <= 4 * (long long)tabla->enteros.size()) {
+            tabla->minimo = tabla->enteros.front().first;
+            tabla->densa.assign(rango, tabla->casos);
+            for (const auto& [clave, caso] : tabla->enteros)
+                tabla->densa[clave - tabla->minimo] = caso;
+        }
+    }
+    return tabla;
+}
+
+// Cadenas convertidas, para el reporte del optimizador
+static std::vector<std::string> convertidas;
+
+// 'x igualito K' o 'K igualito x', con K un int o un texto
+static bool comparacion_constante(AST* cond, AST*& id, AST*& clave) {
+    if (!cond || cond->type != NODE_BINOP || cond->op != OP_EQ) return false;
+    AST* l = cond->data.bin.left;
+    AST* r = cond->data.bin.right;
+    if (r->type == NODE_ID) std::swap(l, r);
+    if (l->type != NODE_ID || (r->type != NODE_INT && r->type != NODE_STRING)) return false;
+    id = l;
+    clave = r;
+    return true;
+}
+
+static std::string nombre_clave(AST* clave) {
+    if (clave->type == NODE_INT) return std::to_string(clave->data.intval);
+    return "\"" + std::string(clave->data.strval) + "\"";
+}
+
+// El cuerpo asigna o lee la variable. Lo que haga una funcion llamada no
+// cuenta: el interprete restaura las variables al volver.
+static bool escribe(AST* tree, const std::string& var) {
+    if (!tree || tree->type == NODE_FUNC_DEF) return false;
+    AST* destino = nullptr;
+    if (tree->type == NODE_ASSIGN) destino = tree->data.bin.left;
+    else if (tree->type == NODE_INPUT) destino = tree->data.input.variable;
+    else if (tree->type == NODE_INDEX_ASSIGN) destino = tree->data.index.lista;
+    if (destino && var == destino->data.id) return true;
+    for (AST** hijo : ast_hijos(tree))
+        if (escribe(*hijo, var)) return true;
+    return false;
+}
+
+static void anotar(AST* segun, const char* forma, int si_po) {
+    const TablaSegun* tabla = segun->data.segun.tabla;
+    std::string busqueda = !tabla->densa.empty() ? "tabla directa" : "busqueda binaria";
+    convertidas.push_back(std::string(segun->data.segun.expr->data.id) + ": " + std::to_string(si_po) +
+                          " si_po " + forma + ", " + busqueda);
+}
+
+// si_po (x igualito 1) A si_no_po si_po (x igualito 2) B si_no_po ... C
+static AST* cadena_si_no(AST* tree) {
+    AST* id;
+    AST* clave;
+    if (!comparacion_constante(tree->data.ctrl.cond, id, clave)) return nullptr;
+
+    std::vector<AST*>* casos = new std::vector<AST*>();
+    std::set<std::string> vistas;
+    AST* actual = tree;
+    AST* otro;
+    int n = 0;
+    while (actual && actual->type == NODE_IF && comparacion_constante(actual->data.ctrl.cond, otro, clave) &&
+           std::string(otro->data.id) == id->data.id) {
+        // una clave repetida nunca llega a su rama
+        if (vistas.insert(nombre_clave(clave)).second) {
+            casos->push_back(clave);
+            casos->push_back(actual->data.ctrl.then_branch);
+        }
+        actual = actual->data.ctrl.else_branch;
+        n++;
+    }
+    if (n < SEGUN_MIN_CASOS) {
+        delete casos;
+        return nullptr;
+    }
+    AST* segun = make_segun(id, casos, actual);
+    anotar(segun, "encadenados", n);
+    return segun;
+}
+
+// si_po seguidos, sin si_no_po, sobre la misma variable y con claves distintas:
+// mientras ningun cuerpo cambie la variable, a lo mas uno se ejecuta
+static std::vector<AST*> juntar_seguidos(const std::vector<AST*>& sentencias) {
+    std::vector<AST*> quedan;
+    size_t i = 0;
+    while (i < sentencias.size()) {
+        std::vector<AST*>* casos = new std::vector<AST*>();
+        std::set<std::string> vistas;
+        AST* id = nullptr;
+        size_t fin = i;
+        while (fin < sentencias.size()) {
+            AST* s = sentencias[fin];
+            AST* otro;
+            AST* clave;
+            if (s->type != NODE_IF || s->data.ctrl.else_branch ||
+                !comparacion_constante(s->data.ctrl.cond, otro, clave))
+                break;
+            if (id && std::string(id->data.id) != otro->data.id) break;
+            if (!vistas.insert(nombre_clave(clave)).second) break;
+            if (!id) id = otro;
+            casos->push_back(clave);
+            casos->push_back(s->data.ctrl.then_branch);
+            fin++;
+            // despues de un cuerpo que cambia la variable se vuelve a comparar
+            if (escribe(s->data.ctrl.then_branch, id->data.id)) break;
+        }
+
+        if (fin - i >= (size_t)SEGUN_MIN_CASOS) {
+            AST* segun = make_segun(id, casos, nullptr);
+            segun->data.segun.valor_del_ultimo = true;
+            anotar(segun, "seguidos", (int)(fin - i));
+            quedan.push_back(segun);
+            i = fin;
+        } else {
+            delete casos;
+            quedan.push_back(sentencias[i]);
+            i++;
+        }
+    }
+    return quedan;
+}
+
+static void aplanar(AST* tree, std::vector<AST*>& sentencias) {
+    if (!tree) return;
+    if (tree->type == NODE_SEQ) {
+        aplanar(tree->data.seq.first, sentencias);
+        aplanar(tree->data.seq.second, sentencias);
+    } else {
+        sentencias.push_back(tree);
+    }
+}
+
+static AST* convertir(AST* tree) {
+    if (!tree) return nullptr;
+    if (tree->type == NODE_IF) {
+        if (AST* segun = cadena_si_no(tree)) tree = segun;
+    } else if (tree->type == NODE_SEQ) {
+        std::vector<AST*> sentencias;
+        aplanar(tree, sentencias);
+        std::vector<AST*> nuevas = juntar_seguidos(sentencias);
+        bool cambio = nuevas.size() != sentencias.size();
+        for (AST*& s : nuevas) {
+            AST* convertida = convertir(s);
+            cambio = cambio || convertida != s;
+            s = convertida;
+        }
+        if (!cambio) return tree;
+        AST* seq = nuevas[0];
+        for (size_t i = 1; i < nuevas.size(); ++i) seq = make_seq(seq, nuevas[i]);
+        return seq;
+    }
+    for (AST** hijo : ast_hijos(tree))
+        *hijo = convertir(*hijo);
+    return tree;
+}
+
+// Cadenas de si_po que comparan la misma variable con constantes: quedan como
+// un segun, que salta directo al caso en vez de probar uno por uno
+AST* optimizar_segun(AST* tree) {
+    convertidas.clear();
+    tree = convertir(tree);
+    if (reporte_optimizador && !convertidas.empty()) {
+        std::cerr << "--- Cadenas de si_po ---\n";
+        for (const std::string& linea : convertidas)
+            std::cerr << "segun " << linea << "\n";
+    }
+    return tree;
+}
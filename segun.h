@@ -0,0 +1,29 @@
+#ifndef SEGUN_H
+#define SEGUN_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "ast.h"
+
+// Tabla de saltos de un segun_la_wa: del valor de la clave al numero de caso.
+// Si las claves enteras estan cerca se usa un arreglo indexado por la clave;
+// si estan dispersas, busqueda binaria. Los textos van por busqueda binaria.
+// Como igualito, un int solo coincide con claves int (1.0 no es el caso 1).
+struct TablaSegun {
+    int casos = 0;                                   // buscar da 'casos' si ninguno coincide
+    int minimo = 0;
+    std::vector<int> densa;                          // densa[clave - minimo], vacia si no conviene
+    std::vector<std::pair<int, int>> enteros;        // (clave, caso) ordenadas por clave
+    std::vector<std::pair<std::string, int>> textos; // (clave, caso) ordenadas por clave
+
+    int buscar(const Value& v) const;
+};
+
+// Arma la tabla con las claves de los casos (NODE_INT o NODE_STRING)
+TablaSegun* armar_tabla_segun(const std::vector<AST*>& claves);
+
+// Cantidad minima de si_po sobre la misma variable para convertirlos en segun
+const int SEGUN_MIN_CASOS = 3;
+
+#endif
@@ -0,0 +1,222 @@
+#!/bin/bash
+# Prueba los programas de test/ que tienen salida esperada en test/esperado/.
+# Cada uno se ejecuta con el interprete del arbol, con --ir y compilado desde el
+# C++ generado (el del arbol y el de la IR), y las cuatro salidas tienen que ser
+# iguales a la esperada. Si existe test/entradas/<nombre>.txt se usa como entrada,
+# y una linea "// opciones: ..." en el programa agrega opciones al compilador.
+# Uso (desde la raiz del repositorio, con chileno_compilador ya compilado):
+#   ./test/probar.sh [programas...]
+# CXX y CXXFLAGS eligen el compilador de C++ (por defecto g++ -O2 -std=c++17).
+
+raiz="$(pwd)"
+compilador="$raiz/chileno_compilador"
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2 -std=c++17}
+
+programas=()
+for arg in "$@"; do
+    programas+=("$(realpath "$arg")")
+done
+if [ ${#programas[@]} -eq 0 ]; then
+    for esperado in "$raiz"/test/esperado/*.txt; do
+        programas+=("$raiz/test/$(basename "$esperado")")
+    done
+fi
+
+if [ ! -x "$compilador" ]; then
+    echo "No se encontro $compilador" >&2
+    exit 1
+fi
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+cd "$dir"
+
+fallas=0
+fallar() {
+    echo "FALLA $1: $2"
+    fallas=$((fallas + 1))
+}
+
+# Salida del programa: lo que queda entre la ejecucion y la generacion de C++
+salida_programa() {
+    sed -n '/^--- Ejecucion del programa ---$/,/^--- Generando codigo C++ ---$/p' | sed '1d;$d' | sed '$d'
+}
+
+# Compila cpp_chileno.cpp y lo ejecuta con la entrada del programa
+ejecutar_cpp() {
+    $CXX $CXXFLAGS -o programa cpp_chileno.cpp 2> compilacion.txt || return 1
+    ./programa < "$2" > "$1"
+}
+
+for prog in "${programas[@]}"; do
+    nombre=$(basename "$prog" .txt)
+    esperado="$raiz/test/esperado/$nombre.txt"
+    entrada="$raiz/test/entradas/$nombre.txt"
+    [ -f "$entrada" ] || entrada=/dev/null
+    opciones=$(sed -n 's|^// opciones: ||p' "$prog")
+    antes=$fallas
+
+    "$compilador" $opciones "$prog" < "$entrada" 2> /dev/null > completo.txt || fallar "$nombre" "codigo de salida $?"
+    salida_programa < completo.txt > interprete.txt
+    cmp -s interprete.txt "$esperado" || fallar "$nombre" "interprete"
+    if ! ejecutar_cpp cpp.txt "$entrada"; then
+        fallar "$nombre" "el C++ no compila"
+    else
+        cmp -s cpp.txt "$esperado" || fallar "$nombre" "C++"
+    fi
+
+    "$compilador" --ir $opciones "$prog" < "$entrada" 2> /dev/null > completo.txt || fallar "$nombre" "codigo de salida $? con --ir"
+    salida_programa < completo.txt > ir.txt
+    cmp -s ir.txt "$esperado" || fallar "$nombre" "--ir"
+    if ! ejecutar_cpp cpp_ir.txt "$entrada"; then
+        fallar "$nombre" "el C++ de --ir no compila"
+    else
+        cmp -s cpp_ir.txt "$esperado" || fallar "$nombre" "C++ de --ir"
+    fi
+
+    [ $fallas -eq $antes ] && echo "ok $nombre"
+done
+
+# Programas que se prueban de otra forma (solo si no se eligieron programas)
+if [ $# -eq 0 ]; then
+    # una funcion recursiva que devuelve numeros y textos se interpreta, pero no
+    # se escribe en C++
+    "$compilador" "$raiz/test/recursion_mixta.txt" > completo.txt 2> errores.txt
+    codigo=$?
+    if [ $codigo -ne 1 ] || [ -f cpp_chileno.cpp ] || ! grep -q "no se puede generar C++" errores.txt; then
+        fallar recursion_mixta "se esperaba un error al generar C++ (codigo $codigo)"
+    elif [ "$(salida_programa < completo.txt)" != "xxx0" ]; then
+        fallar recursion_mixta "interprete"
+    else
+        echo "ok recursion_mixta"
+    fi
+
+    # un argumento que no se usa y falla sigue terminando el programa con inline
+    antes=$fallas
+    for ir in "" --ir; do
+        "$compilador" $ir "$raiz/test/inline_error.txt" > completo.txt 2> errores.txt
+        codigo=$?
+        [ $codigo -eq 1 ] || fallar inline_error "codigo de salida $codigo $ir"
+        # el error termina antes de generar C++: la salida va hasta el final
+        [ "$(sed '1,/^--- Ejecucion del programa ---$/d' completo.txt | tr '\n' ' ')" = "0 0 " ] ||
+            fallar inline_error "salida $ir"
+        grep -q "indice fuera de rango" errores.txt || fallar inline_error "sin error de indice $ir"
+    done
+    [ $fallas -eq $antes ] && echo "ok inline_error"
+
+    # un valor nulo a la derecha de un string da el error de la suma y queda nulo;
+    # a la izquierda cuenta como texto vacio
+    antes=$fallas
+    for ir in "" --ir; do
+        "$compilador" $ir "$raiz/test/concat_nula.txt" > completo.txt 2> errores.txt ||
+            fallar concat_nula "codigo de salida $? $ir"
+        [ "$(salida_programa < completo.txt | tr '\n' ' ')" = "null bc " ] || fallar concat_nula "salida $ir"
+        [ "$(grep -c "^Error: No se puede convertir RHS a string$" errores.txt)" -eq 1 ] ||
+            fallar concat_nula "sin el error de la suma $ir"
+    done
+    [ $fallas -eq $antes ] && echo "ok concat_nula"
+
+    # minimo/maximo de una lista vacia: el interprete (con una lista de 3) genera el
+    # C++, y el C++ con una lista vacia termina con el mismo error
+    antes=$fallas
+    echo 3 | "$compilador" "$raiz/test/lista_vacia.txt" > completo.txt 2> /dev/null || fallar lista_vacia "interprete"
+    [ "$(salida_programa < completo.txt | tr '\n' ' ')" = "2 0 " ] || fallar lista_vacia "salida del interprete"
+    echo 0 | "$compilador" "$raiz/test/lista_vacia.txt" > /dev/null 2> errores.txt
+    grep -q "^Error: maximo de una lista vacia$" errores.txt || fallar lista_vacia "sin error del interprete"
+    echo 3 | "$compilador" "$raiz/test/lista_vacia.txt" > /dev/null 2>&1
+    if ! $CXX $CXXFLAGS -o programa cpp_chileno.cpp 2> compilacion.txt; then
+        fallar lista_vacia "el C++ no compila"
+    else
+        echo 0 | ./programa > /dev/null 2> errores.txt
+        codigo=$?
+        [ $codigo -eq 1 ] || fallar lista_vacia "codigo de salida del C++ $codigo"
+        grep -q "^Error: maximo de una lista vacia$" errores.txt || fallar lista_vacia "sin error en el C++"
+    fi
+    [ $fallas -eq $antes ] && echo "ok lista_vacia"
+
+    # --mem-stats: el pico de variables cuenta las listas que se asignan (xs e ys
+    # de memoria.txt ocupan 8000 bytes juntas), tambien en la IR
+    antes=$fallas
+    for ir in "" --ir; do
+        "$compilador" $ir --mem-stats=json "$raiz/test/memoria.txt" > /dev/null 2> errores.txt
+        pico=$(grep -o '"pico_bytes_variables": [0-9]*' errores.txt | grep -o '[0-9]*$')
+        [ "${pico:-0}" -ge 8000 ] || fallar memoria "pico de variables ${pico:-ninguno} $ir"
+    done
+    [ $fallas -eq $antes ] && echo "ok memoria con --mem-stats"
+
+    # --pgo-usar con el perfil que grabo --pgo-grabar para el mismo programa
+    antes=$fallas
+    "$compilador" --pgo-grabar=perfil.pgo "$raiz/test/pgo.txt" > /dev/null 2>&1 || fallar pgo "--pgo-grabar"
+    for ir in "" --ir; do
+        "$compilador" $ir --pgo-usar=perfil.pgo "$raiz/test/pgo.txt" > completo.txt 2> /dev/null || fallar pgo "--pgo-usar $ir"
+        salida_programa < completo.txt | cmp -s - "$raiz/test/esperado/pgo.txt" || fallar pgo "salida con --pgo-usar $ir"
+        ejecutar_cpp cpp.txt /dev/null && cmp -s cpp.txt "$raiz/test/esperado/pgo.txt" || fallar pgo "C++ con --pgo-usar $ir"
+    done
+    [ $fallas -eq $antes ] && echo "ok pgo con --pgo-usar"
+
+    # --foto-usar sigue desde foto_la_wa con las listas compartidas como estaban
+    antes=$fallas
+    "$compilador" --foto-grabar=estado.foto "$raiz/test/foto.txt" > completo.txt 2> /dev/null || fallar foto "--foto-grabar"
+    salida_programa < completo.txt | cmp -s - "$raiz/test/esperado/foto.txt" || fallar foto "salida con --foto-grabar"
+    "$compilador" --foto-usar=estado.foto "$raiz/test/foto.txt" > completo.txt 2> errores.txt || fallar foto "--foto-usar"
+    salida_programa < completo.txt | cmp -s - "$raiz/test/esperado/foto.txt" || fallar foto "salida con --foto-usar"
+    [ -s errores.txt ] && fallar foto "no se uso la foto: $(head -1 errores.txt)"
+    [ $fallas -eq $antes ] && echo "ok foto con --foto-usar"
+
+    # --lote: cada registro con su propia salida; los que leen una columna que no
+    # tienen se informan como error y el resto del lote sigue
+    antes=$fallas
+    for ir in "" --ir; do
+        "$compilador" $ir --lote="$raiz/test/lote.csv" --lote-hilos=2 "$raiz/test/lote.txt" > salida.txt 2> errores.txt ||
+            fallar lote "codigo de salida $? $ir"
+        cmp -s salida.txt "$raiz/test/esperado/lote.salida" || fallar lote "salida $ir"
+        [ "$(grep -o '"registro": [0-9]*, "estado": "error"' errores.txt | tr '\n' ' ')" = \
+          '"registro": 3, "estado": "error" "registro": 5, "estado": "error" ' ] || fallar lote "errores $ir"
+    done
+    [ $fallas -eq $antes ] && echo "ok lote con --lote"
+
+    # --limite-pasos detiene un ciclo que no termina con codigo 2 y su resultado
+    antes=$fallas
+    for ir in "" --ir; do
+        "$compilador" $ir --limite-pasos=100000 "$raiz/test/limite.txt" > completo.txt 2> errores.txt
+        codigo=$?
+        [ $codigo -eq 2 ] || fallar limite "codigo de salida $codigo $ir"
+        [ "$(salida_programa < completo.txt)" = "empieza" ] || fallar limite "salida $ir"
+        grep -q '"estado": "limite_pasos", "pasos": 100001' errores.txt || fallar limite "resultado $ir"
+        # una lista o un texto grande se revisa apenas se crea
+        "$compilador" $ir --limite-memoria=64 "$raiz/test/limite_memoria.txt" > completo.txt 2> errores.txt
+        codigo=$?
+        [ $codigo -eq 2 ] || fallar limite "codigo de salida $codigo con --limite-memoria $ir"
+        [ "$(salida_programa < completo.txt)" = "empieza" ] || fallar limite "salida con --limite-memoria $ir"
+        grep -q '"estado": "limite_memoria"' errores.txt || fallar limite "resultado con --limite-memoria $ir"
+    done
+    [ $fallas -eq $antes ] && echo "ok limite con --limite-pasos y --limite-memoria"
+
+    # --planificar: el ciclo se detiene por el limite y el error solo detiene a su
+    # programa; el otro termina con su salida completa
+    antes=$fallas
+    seccion() {
+        sed -n "\|^--- $raiz/test/$1.txt ---\$|,/^--- /p" salida.txt | sed '1d;/^--- /d'
+    }
+    for ir in "" --ir; do
+        "$compilador" $ir --planificar=2 --turno=1000 --limite-pasos=100000 "$raiz/test/limite.txt" \
+            "$raiz/test/error.txt" "$raiz/test/concatenacion.txt" > salida.txt 2> errores.txt
+        codigo=$?
+        [ $codigo -eq 2 ] || fallar planificador "codigo de salida $codigo $ir"
+        seccion concatenacion | cmp -s - "$raiz/test/esperado/concatenacion.txt" || fallar planificador "concatenacion $ir"
+        [ "$(seccion error)" = "3" ] || fallar planificador "salida de error.txt $ir"
+        [ "$(seccion limite)" = "empieza" ] || fallar planificador "salida de limite.txt $ir"
+        grep -q 'concatenacion.txt", "estado": "terminada"' errores.txt || fallar planificador "concatenacion.txt no termino $ir"
+        grep -q 'error.txt", "estado": "error".*"mensaje": "indice fuera de rango"' errores.txt ||
+            fallar planificador "resultado de error.txt $ir"
+        grep -q 'limite.txt", "estado": "limite_pasos"' errores.txt || fallar planificador "resultado de limite.txt $ir"
+    done
+    [ $fallas -eq $antes ] && echo "ok planificador con --planificar"
+fi
+
+if [ $fallas -gt 0 ]; then
+    echo "$fallas fallas"
+    exit 1
+fi
+echo "todo ok"